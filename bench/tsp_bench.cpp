@@ -0,0 +1,528 @@
+/**
+ * Optimality gap benchmark for the TSP solvers.
+ *
+ * Every solver is run on every instance of the set that has an .opt.tour
+ * file, once per seed. A run restarts the solver with the same parameters
+ * until its time or evaluation budget is used up and reports the best gap to
+ * the optimum, the time at which the target gap was first reached and
+ * evaluations per second, as CSV and/or JSON. The budgets and the target are
+ * polled by the solvers every iteration, so a run stops as soon as the budget
+ * is used up and reaching the target inside a run is timed where it happens.
+ *
+ *   make bench && build/bench/tsp_bench --instances a280,pr1002 --solvers SA,GA \
+ *       --seeds 5 --time-budget 30 --csv results.csv --json results.json
+ */
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "random/random.hpp"
+#include "physics/SA.hpp"
+#include "math/TS.hpp"
+#include "evolutionary/GA.hpp"
+#include "swarm/ACO.hpp"
+#include "problems/TSP.hpp"
+#include "problems/TSPLIB.hpp"
+
+using namespace problems::tsp;
+
+namespace
+{
+
+struct Options
+{
+    std::string data = "data/tsp";
+    std::vector<std::string> instances;
+    std::vector<std::string> solvers = {"SA", "TS", "GA", "ACO"};
+    int seeds = 3;
+    double timeBudget = 10;
+    long long evalBudget = 0;
+    double target = 5;
+    InitialTour initialTour = InitialTour::RANDOM;
+    bool localSearch = false;
+    int neighbors = 10;
+    std::vector<double> sa = {100, 0.01, 0.9999};
+    std::vector<double> ts = {1000, 50, 50};
+    std::vector<double> ga = {100, 50, 0.1, 3};
+    std::vector<double> aco = {10, 10, 1, 2, 0.1};
+    evolutionary::GA::CrossoverType crossover = evolutionary::GA::CrossoverType::ONE_POINT;
+    std::vector<double> islands = {1, 10, 1};
+    evolutionary::GA::MigrationTopology topology = evolutionary::GA::MigrationTopology::RING;
+    evolutionary::GA::SelectionType selection = evolutionary::GA::SelectionType::TOURNAMENT;
+    bool steadyState = false;
+    long long cache = 0;
+    math::TS::TabuMode tabuMode = math::TS::TabuMode::SOLUTION;
+    int threads = 1;
+    swarm::ACO::PheromoneLayout pheromone = swarm::ACO::PheromoneLayout::DENSE;
+    swarm::ACO::PheromoneUpdate update = swarm::ACO::PheromoneUpdate::BEST;
+    std::string csv;
+    std::string json;
+};
+
+struct Result
+{
+    std::string instance;
+    int n;
+    std::string solver;
+    int seed;
+    double optimum;
+    double best;
+    double gap;
+    double timeToTarget;
+    int runs;
+    double seconds;
+    long long evaluations;
+    long long moveEvaluations;
+};
+
+const char* USAGE =
+    "usage: tsp_bench [options]\n"
+    "  --data DIR              directory of the .tsp and .opt.tour files (data/tsp)\n"
+    "  --instances A,B,...     instance names (every one with an .opt.tour file)\n"
+    "  --solvers SA,TS,GA,ACO  solvers to run (all)\n"
+    "  --seeds N               runs per instance and solver, seeded 1..N (3)\n"
+    "  --time-budget S         seconds per run (10)\n"
+    "  --eval-budget N         evaluations per run, move evaluations included (0, none)\n"
+    "  --target GAP            gap in percent for time-to-target (5)\n"
+    "  --init TYPE             random, nn, greedy or sfc initial tours (random)\n"
+    "  --local-search          2-opt + Or-opt on every solution\n"
+    "  --neighbors K           candidate list size, 0 to disable (10)\n"
+    "  --sa maxT,minT,k        SimulatedAnnealing::solve arguments (100,0.01,0.9999)\n"
+    "  --ts it,tabu,neigh      TabuSearch::solve arguments (1000,50,50)\n"
+    "  --tabu MODE             solution or attribute (move) tabu list (solution)\n"
+    "  --ga gen,pop,mut,sel    GeneticAlgorithm::solve arguments (100,50,0.1,3)\n"
+    "  --aco gen,col,a,b,rho   AntColonyOptimization::solve arguments (10,10,1,2,0.1)\n"
+    "  --crossover TYPE        one, ox, pmx, cx or eax GA crossover (one)\n"
+    "  --islands n,int,mig     GeneticAlgorithm::setIslands arguments (1,10,1)\n"
+    "  --topology TOPOLOGY     ring or full island migration (ring)\n"
+    "  --selection TYPE        tournament, proportional, sus or rank GA selection (tournament)\n"
+    "  --steady-state          GA children replace the worst individuals as they are made,\n"
+    "                          with tournament selection only\n"
+    "  --cache N               evaluation cache of N entries, 0 for none (0)\n"
+    "  --threads N             threads for the GA and ACO, 0 for all hardware threads (1)\n"
+    "  --pheromone LAYOUT      dense, symmetric or sparse pheromone matrix (dense)\n"
+    "  --update RULE           best or mmas (MAX-MIN) pheromone update (best)\n"
+    "  --csv FILE, --json FILE where to write the results\n";
+
+std::vector<std::string> split(const std::string& s)
+{
+    std::vector<std::string> parts;
+    std::stringstream stream(s);
+    std::string part;
+    while (std::getline(stream, part, ','))
+    {
+        if (!part.empty())
+            parts.push_back(part);
+    }
+    return parts;
+}
+
+std::vector<double> numbers(const std::string& s, size_t count)
+{
+    std::vector<double> values;
+    for (const std::string& part: split(s))
+        values.push_back(std::atof(part.c_str()));
+    if (values.size() != count)
+        throw std::runtime_error("expected " + std::to_string(count) + " comma separated values, got " + s);
+    return values;
+}
+
+Options parseOptions(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+        {
+            std::cout << USAGE;
+            std::exit(0);
+        }
+        if (arg == "--local-search")
+        {
+            options.localSearch = true;
+            continue;
+        }
+        if (arg == "--steady-state")
+        {
+            options.steadyState = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+            throw std::runtime_error("missing value for " + arg);
+
+        std::string value = argv[++i];
+        if (arg == "--data")
+            options.data = value;
+        else if (arg == "--instances")
+            options.instances = split(value);
+        else if (arg == "--solvers")
+            options.solvers = split(value);
+        else if (arg == "--seeds")
+            options.seeds = std::atoi(value.c_str());
+        else if (arg == "--time-budget")
+            options.timeBudget = std::atof(value.c_str());
+        else if (arg == "--eval-budget")
+            options.evalBudget = std::atoll(value.c_str());
+        else if (arg == "--target")
+            options.target = std::atof(value.c_str());
+        else if (arg == "--neighbors")
+            options.neighbors = std::atoi(value.c_str());
+        else if (arg == "--sa")
+            options.sa = numbers(value, 3);
+        else if (arg == "--ts")
+            options.ts = numbers(value, 3);
+        else if (arg == "--ga")
+            options.ga = numbers(value, 4);
+        else if (arg == "--aco")
+            options.aco = numbers(value, 5);
+        else if (arg == "--crossover")
+        {
+            if (value == "one")
+                options.crossover = evolutionary::GA::CrossoverType::ONE_POINT;
+            else if (value == "ox")
+                options.crossover = evolutionary::GA::CrossoverType::ORDER;
+            else if (value == "pmx")
+                options.crossover = evolutionary::GA::CrossoverType::PARTIALLY_MAPPED;
+            else if (value == "cx")
+                options.crossover = evolutionary::GA::CrossoverType::CYCLE;
+            else if (value == "eax")
+                options.crossover = evolutionary::GA::CrossoverType::EDGE_ASSEMBLY;
+            else
+                throw std::runtime_error("unknown crossover " + value);
+        }
+        else if (arg == "--islands")
+            options.islands = numbers(value, 3);
+        else if (arg == "--topology")
+        {
+            if (value == "ring")
+                options.topology = evolutionary::GA::MigrationTopology::RING;
+            else if (value == "full")
+                options.topology = evolutionary::GA::MigrationTopology::FULLY_CONNECTED;
+            else
+                throw std::runtime_error("unknown migration topology " + value);
+        }
+        else if (arg == "--selection")
+        {
+            if (value == "tournament")
+                options.selection = evolutionary::GA::SelectionType::TOURNAMENT;
+            else if (value == "proportional")
+                options.selection = evolutionary::GA::SelectionType::PROPORTIONAL;
+            else if (value == "sus")
+                options.selection = evolutionary::GA::SelectionType::STOCHASTIC_UNIVERSAL;
+            else if (value == "rank")
+                options.selection = evolutionary::GA::SelectionType::RANK;
+            else
+                throw std::runtime_error("unknown selection " + value);
+        }
+        else if (arg == "--tabu")
+        {
+            if (value == "solution")
+                options.tabuMode = math::TS::TabuMode::SOLUTION;
+            else if (value == "attribute")
+                options.tabuMode = math::TS::TabuMode::ATTRIBUTE;
+            else
+                throw std::runtime_error("unknown tabu mode " + value);
+        }
+        else if (arg == "--cache")
+            options.cache = std::atoll(value.c_str());
+        else if (arg == "--threads")
+            options.threads = std::atoi(value.c_str());
+        else if (arg == "--csv")
+            options.csv = value;
+        else if (arg == "--json")
+            options.json = value;
+        else if (arg == "--pheromone")
+        {
+            if (value == "dense")
+                options.pheromone = swarm::ACO::PheromoneLayout::DENSE;
+            else if (value == "symmetric")
+                options.pheromone = swarm::ACO::PheromoneLayout::SYMMETRIC;
+            else if (value == "sparse")
+                options.pheromone = swarm::ACO::PheromoneLayout::SPARSE;
+            else
+                throw std::runtime_error("unknown pheromone layout " + value);
+        }
+        else if (arg == "--update")
+        {
+            if (value == "best")
+                options.update = swarm::ACO::PheromoneUpdate::BEST;
+            else if (value == "mmas")
+                options.update = swarm::ACO::PheromoneUpdate::MAX_MIN;
+            else
+                throw std::runtime_error("unknown pheromone update " + value);
+        }
+        else if (arg == "--init")
+        {
+            if (value == "random")
+                options.initialTour = InitialTour::RANDOM;
+            else if (value == "nn")
+                options.initialTour = InitialTour::NEAREST_NEIGHBOR;
+            else if (value == "greedy")
+                options.initialTour = InitialTour::GREEDY;
+            else if (value == "sfc")
+                options.initialTour = InitialTour::SPACE_FILLING_CURVE;
+            else
+                throw std::runtime_error("unknown initial tour " + value);
+        }
+        else
+            throw std::runtime_error("unknown option " + arg + "\n" + USAGE);
+    }
+
+    if (options.steadyState && options.selection != evolutionary::GA::SelectionType::TOURNAMENT)
+        throw std::runtime_error("--steady-state needs --selection tournament");
+    return options;
+}
+
+// names of the instances in dir that come with an optimal tour
+std::vector<std::string> instancesWithOptimum(const std::string& dir)
+{
+    const std::string suffix = ".opt.tour";
+    std::vector<std::string> names;
+
+    DIR* handle = opendir(dir.c_str());
+    if (!handle)
+        throw std::runtime_error("cannot open directory " + dir);
+
+    while (dirent* entry = readdir(handle))
+    {
+        std::string file = entry->d_name;
+        if (file.size() > suffix.size() && file.compare(file.size() - suffix.size(), suffix.size(), suffix) == 0)
+            names.push_back(file.substr(0, file.size() - suffix.size()));
+    }
+    closedir(handle);
+
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+double now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template <typename TSPType>
+std::shared_ptr<TSPType> makeProblem(const Instance& instance, const Options& options)
+{
+    std::shared_ptr<TSPType> problem = std::make_shared<TSPType>(instance);
+    if (options.neighbors > 0)
+        problem->buildNeighborLists(options.neighbors);
+    if (options.localSearch)
+        problem->setLocalSearch(true);
+    problem->setInitialTour(options.initialTour);
+    problem->setEvaluationCache(options.cache);
+    return problem;
+}
+
+// the optimum is the length of the .opt.tour under the instance's own metric
+double optimum(const Instance& instance, const std::vector<int>& tour)
+{
+    TSP problem(instance);
+    TSSPtr tss = std::make_shared<TSS>();
+    tss->tour = tour;
+    return problem.evaluateSolution(tss);
+}
+
+// the length of a tour a run returned, outside of the problem's evaluation
+// counters so checking it does not count against the budget
+double tourLength(const TSP& problem, const common::SolutionPtr& sol)
+{
+    if (LinkedTSSPtr linked = std::dynamic_pointer_cast<LinkedTSS>(sol))
+        return problem.evaluateTour(linked->getTour().data());
+    return problem.evaluateTour(std::static_pointer_cast<TSS>(sol)->tour.data());
+}
+
+Result benchmark(const std::string& name, const Instance& instance, double opt, const std::string& solver, int seed, const Options& options)
+{
+    mhac_random::seed(seed);
+
+    // one restart of the solver, the problem is kept for its counters
+    std::shared_ptr<TSP> problem;
+    std::function<common::SolutionPtr()> run;
+
+    if (solver == "SA")
+    {
+        problem = makeProblem<TSP>(instance, options);
+        std::shared_ptr<physics::SA::SimulatedAnnealing> sa = std::make_shared<physics::SA::SimulatedAnnealing>(problem);
+        run = [sa, &options]() { return sa->solve(options.sa[0], options.sa[1], options.sa[2]); };
+    }
+    else if (solver == "TS")
+    {
+        problem = makeProblem<TSP>(instance, options);
+        std::shared_ptr<math::TS::TabuSearch> ts = std::make_shared<math::TS::TabuSearch>(problem);
+        ts->setTabuMode(options.tabuMode);
+        run = [ts, &options]() { return ts->solve(options.ts[0], options.ts[1], options.ts[2]); };
+    }
+    else if (solver == "GA")
+    {
+        std::shared_ptr<GA_TSP> gaProblem = makeProblem<GA_TSP>(instance, options);
+        if (options.crossover == evolutionary::GA::CrossoverType::EDGE_ASSEMBLY)
+            gaProblem->setEdgeAssembly(true);
+        else
+            gaProblem->crossoverType = options.crossover;
+        problem = gaProblem;
+        run = [gaProblem, &options]() {
+            evolutionary::GA::GeneticAlgorithm ga(gaProblem);
+            ga.setThreads(options.threads);
+            ga.setIslands(options.islands[0], options.islands[1], options.islands[2], options.topology);
+            ga.setSteadyState(options.steadyState);
+            return ga.solve(options.ga[0], options.ga[1], options.ga[2], options.ga[3], options.selection);
+        };
+    }
+    else if (solver == "ACO")
+    {
+        std::shared_ptr<ACO_TSP> acoProblem = makeProblem<ACO_TSP>(instance, options);
+        problem = acoProblem;
+        std::shared_ptr<swarm::ACO::AntColonyOptimization> aco = std::make_shared<swarm::ACO::AntColonyOptimization>(acoProblem);
+        aco->setThreads(options.threads);
+        aco->setPheromoneLayout(options.pheromone);
+        aco->setPheromoneUpdate(options.update);
+        run = [aco, &options]() { return aco->solve(options.aco[0], options.aco[1], options.aco[2], options.aco[3], options.aco[4]); };
+    }
+    else
+    {
+        throw std::runtime_error("unknown solver " + solver);
+    }
+
+    Result result = {name, (int) instance.cities.size(), solver, seed, opt, -1, 0, -1, 0, 0, 0, 0};
+    double start = now();
+    double deadline = start + options.timeBudget;
+
+    // polled every iteration of a run; the clock is read about once a
+    // millisecond, the number of polls between two reads follows how long
+    // the solver's iterations take
+    bool expired = false;
+    long long polls = 0, nextRead = 1, stride = 1;
+    double lastRead = start;
+    problem->setStopCondition([&](float bestCost) {
+        if (result.timeToTarget < 0 && 100.0 * (bestCost - opt) / opt <= options.target)
+            result.timeToTarget = now() - start;
+
+        if (options.evalBudget > 0 && problem->evaluations + problem->moveEvaluations >= options.evalBudget)
+            expired = true;
+
+        if (++polls >= nextRead)
+        {
+            double time = now();
+            if (time >= deadline)
+                expired = true;
+            stride = time - lastRead < 1e-3 ? stride * 2 : std::max(stride / 2, 1LL);
+            lastRead = time;
+            nextRead = polls + stride;
+        }
+        return expired;
+    });
+
+    while (true)
+    {
+        common::SolutionPtr best = run();
+        double cost = tourLength(*problem, best);
+        double elapsed = now() - start;
+        result.runs++;
+
+        if (result.best < 0 || cost < result.best)
+            result.best = cost;
+        result.gap = 100.0 * (result.best - opt) / opt;
+        if (result.timeToTarget < 0 && result.gap <= options.target)
+            result.timeToTarget = elapsed;
+
+        long long evaluations = problem->evaluations + problem->moveEvaluations;
+        if (expired || elapsed >= options.timeBudget || (options.evalBudget > 0 && evaluations >= options.evalBudget))
+            break;
+    }
+
+    result.seconds = now() - start;
+    result.evaluations = problem->evaluations;
+    result.moveEvaluations = problem->moveEvaluations;
+    return result;
+}
+
+double evalsPerSecond(const Result& r)
+{
+    return r.seconds > 0 ? (r.evaluations + r.moveEvaluations) / r.seconds : 0;
+}
+
+void writeCSV(const std::string& path, const std::vector<Result>& results)
+{
+    std::ofstream out(path);
+    out << "instance,n,solver,seed,optimum,best,gap,time_to_target,runs,seconds,evaluations,move_evaluations,evals_per_sec\n";
+    for (const Result& r: results)
+    {
+        out << r.instance << "," << r.n << "," << r.solver << "," << r.seed << "," << r.optimum << ","
+            << r.best << "," << r.gap << "," << r.timeToTarget << "," << r.runs << "," << r.seconds << ","
+            << r.evaluations << "," << r.moveEvaluations << "," << evalsPerSecond(r) << "\n";
+    }
+}
+
+void writeJSON(const std::string& path, const std::vector<Result>& results)
+{
+    std::ofstream out(path);
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result& r = results[i];
+        out << "  {\"instance\": \"" << r.instance << "\", \"n\": " << r.n << ", \"solver\": \"" << r.solver
+            << "\", \"seed\": " << r.seed << ", \"optimum\": " << r.optimum << ", \"best\": " << r.best
+            << ", \"gap\": " << r.gap << ", \"time_to_target\": "
+            << (r.timeToTarget < 0 ? std::string("null") : std::to_string(r.timeToTarget))
+            << ", \"runs\": " << r.runs << ", \"seconds\": " << r.seconds << ", \"evaluations\": " << r.evaluations
+            << ", \"move_evaluations\": " << r.moveEvaluations << ", \"evals_per_sec\": " << evalsPerSecond(r) << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        Options options = parseOptions(argc, argv);
+        std::vector<std::string> names = options.instances.empty() ? instancesWithOptimum(options.data) : options.instances;
+        std::vector<Result> results;
+
+        for (const std::string& name: names)
+        {
+            Instance instance = readTSPLIB(options.data + "/" + name + ".tsp");
+            double opt = optimum(instance, readTSPLIBTour(options.data + "/" + name + ".opt.tour"));
+
+            for (const std::string& solver: options.solvers)
+            {
+                for (int seed = 1; seed <= options.seeds; seed++)
+                {
+                    Result r = benchmark(name, instance, opt, solver, seed, options);
+                    results.push_back(r);
+
+                    std::printf("%-12s %-4s seed %-3d gap %7.2f%%  ttt %8.2fs  %5d runs  %12.0f evals/s\n",
+                                r.instance.c_str(), r.solver.c_str(), r.seed, r.gap, r.timeToTarget, r.runs, evalsPerSecond(r));
+                    std::fflush(stdout);
+                }
+            }
+        }
+
+        if (!options.csv.empty())
+            writeCSV(options.csv, results);
+        if (!options.json.empty())
+            writeJSON(options.json, results);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+#ifndef MHAC_CACHE_HPP
+#define MHAC_CACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mhac_cache
+{
+
+struct CacheStats
+{
+    long long lookups = 0;
+    long long hits = 0;
+    long long insertions = 0;
+    long long evictions = 0;     // insertions that overwrote another entry
+
+    double hitRate() const { return lookups > 0 ? (double) hits / lookups : 0; }
+};
+
+/**
+ * Costs of already evaluated solutions by their 64 bit hash, with a fixed
+ * number of entries: a key has a single slot and a newer key taking it
+ * evicts the older one. Keys are trusted, two solutions with the same hash
+ * share a cost; 0 is not a key (Solution::hash() of unhashable solutions),
+ * such solutions are always evaluated and a warning is logged the first time.
+ * TSS and JSSS, python subclasses included, hash their tour or schedule.
+ *
+ * find and insert may be called from several threads, the slots are
+ * guarded by a few mutexes picked by slot.
+ */
+class EvaluationCache
+{
+public:
+    // capacity is rounded up to a power of two
+    explicit EvaluationCache(size_t capacity);
+    EvaluationCache(const EvaluationCache&) = delete;
+    EvaluationCache& operator=(const EvaluationCache&) = delete;
+
+    bool find(std::uint64_t key, float& cost);
+    void insert(std::uint64_t key, float cost);
+
+    // drops the entries and the stats, for when the problem changes
+    void clear();
+
+    size_t capacity() const { return mEntries.size(); }
+    CacheStats stats() const;
+
+private:
+    struct Entry
+    {
+        std::uint64_t key = 0;
+        float cost = 0;
+    };
+
+    std::mutex& lock(size_t slot) { return mLocks[slot % LOCKS]; }
+
+    static const size_t LOCKS = 64;
+
+    std::vector<Entry> mEntries;
+    std::mutex mLocks[LOCKS];
+    std::atomic<long long> mLookups{0};
+    std::atomic<long long> mHits{0};
+    std::atomic<long long> mInsertions{0};
+    std::atomic<long long> mEvictions{0};
+    std::atomic<bool> mWarnedUnhashed{false};
+};
+using EvaluationCachePtr = std::shared_ptr<EvaluationCache>;
+
+} // namespace mhac_cache
+
+#endif // MHAC_CACHE_HPP
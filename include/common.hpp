@@ -1,25 +1,86 @@
 #ifndef MHAC_COMMON_HPP
 #define MHAC_COMMON_HPP
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <vector>
 #include <memory>
+#include <stdexcept>
 
 #include <pybind11/pybind11.h>
 
+#include "cache/cache.hpp"
+
 namespace common
 {
 
+// Zobrist style hash of a sequence: the xor of a key per (position, value),
+// so changing the value at a position updates it in O(1) with hashChange
+inline std::uint64_t positionKey(int position, int value)
+{
+    // splitmix64 finalizer
+    std::uint64_t x = ((std::uint64_t) (unsigned) position << 32 | (unsigned) value) + 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+inline std::uint64_t hashSequence(const int* values, int n)
+{
+    std::uint64_t hash = 0;
+    for (int i = 0; i < n; i++)
+        hash ^= positionKey(i, values[i]);
+    return hash;
+}
+
+inline std::uint64_t hashChange(std::uint64_t hash, int position, int from, int to)
+{
+    return hash ^ positionKey(position, from) ^ positionKey(position, to);
+}
+
+// the hash of a solution kept from one hash() to the next, 0 while unknown;
+// the problem's moves update it, anything else changing the solution in
+// place resets it. Atomic, a shared solution may be hashed by several threads
+class StoredHash
+{
+public:
+    StoredHash() = default;
+    StoredHash(const StoredHash& other) : mValue(other.get()) {}
+    StoredHash& operator=(const StoredHash& other) { set(other.get()); return *this; }
+
+    std::uint64_t get() const { return mValue.load(std::memory_order_relaxed); }
+    void set(std::uint64_t value) { mValue.store(value, std::memory_order_relaxed); }
+    void reset() { set(0); }
+
+private:
+    std::atomic<std::uint64_t> mValue{0};
+};
+
 class Solution
 {
 public:
     virtual ~Solution() = default;
     virtual bool isEqual(const Solution&) const = 0;
+    virtual std::shared_ptr<Solution> clone() const = 0;
     virtual int getSize() const { return 0; }
+    // equal solutions must hash the same, 0 when the solution has no hash,
+    // which also keeps it out of the problem's evaluation cache
+    virtual std::uint64_t hash() const { return 0; }
     float cost = 0;
 };
 using SolutionPtr = std::shared_ptr<Solution>;
 using SolutionVec = std::vector<SolutionPtr>;
 
+// A neighbourhood step described by two positions in the solution encoding,
+// the meaning of i and j is up to the problem (e.g. 2-opt reversal, swap)
+struct Move
+{
+    Move(int i = 0, int j = 0) : i(i), j(j) {}
+    int i;
+    int j;
+};
+
 class PySolution : public Solution
 {
 public:
@@ -28,6 +89,14 @@ public:
     bool isEqual(const Solution& sol) const override {
         PYBIND11_OVERRIDE_PURE(bool, Solution, isEqual, sol);
     }
+
+    std::shared_ptr<Solution> clone() const override {
+        PYBIND11_OVERRIDE_PURE(std::shared_ptr<Solution>, Solution, clone);
+    }
+
+    std::uint64_t hash() const override {
+        PYBIND11_OVERRIDE(std::uint64_t, Solution, hash);
+    }
 };
 using PySolutionPtr = std::shared_ptr<PySolution>;
 
@@ -44,6 +113,94 @@ public:
     virtual SolutionPtr generateInitialSolution() = 0;
     virtual SolutionPtr generateNewSolution(SolutionPtr) = 0;
     virtual float evaluateSolution(SolutionPtr) = 0;
+
+    // optional local improvement the solvers apply to the solutions they
+    // build, it may change the solution in place and must keep its cost valid
+    virtual void improveSolution(SolutionPtr) {}
+
+    /**
+     * Optional move interface, lets solvers modify a solution in place and
+     * score the change without copying or re-evaluating the whole solution.
+     * Problems providing it override supportsMoves() to return true.
+     *
+     *      m = generateMove(S)
+     *      delta = evaluateMove(S, m)   // cost(S after m) - cost(S)
+     *      applyMove(S, m)
+     *      undoMove(S, m)               // S is back to its previous state
+     */
+    virtual bool supportsMoves() const { return false; }
+    virtual Move generateMove(SolutionPtr) {
+        throw std::logic_error("generateMove is not supported by this problem");
+    }
+    virtual float evaluateMove(SolutionPtr, const Move&) {
+        throw std::logic_error("evaluateMove is not supported by this problem");
+    }
+    virtual void applyMove(SolutionPtr, const Move&) {
+        throw std::logic_error("applyMove is not supported by this problem");
+    }
+    virtual void undoMove(SolutionPtr, const Move&) {
+        throw std::logic_error("undoMove is not supported by this problem");
+    }
+
+    // hash of the solution move would lead to, given hash, the one of the
+    // solution now; the default applies the move, hashes and undoes it
+    virtual std::uint64_t hashAfterMove(SolutionPtr sol, std::uint64_t hash, const Move& move) {
+        applyMove(sol, move);
+        std::uint64_t after = sol->hash();
+        undoMove(sol, move);
+        return after;
+    }
+    // what attribute based tabu search forbids for a while once move is made,
+    // e.g. the cities or jobs it moves; a move and the one undoing it should
+    // share it, the default is the pair of positions
+    virtual std::uint64_t moveAttribute(SolutionPtr, const Move& move) {
+        return (std::uint64_t) (unsigned) move.i << 32 | (unsigned) move.j;
+    }
+
+    /**
+     * Optional cache of evaluateSolution by Solution::hash(), for problems
+     * whose evaluation costs much more than a hash (e.g. written in Python).
+     * The solvers evaluate whole solutions through evaluate(), which only
+     * calls evaluateSolution for solutions not seen yet. Solutions hashing
+     * to 0, e.g. python ones without a hash(), are always evaluated.
+     */
+    void setEvaluationCache(size_t capacity) {
+        evaluationCache = capacity > 0 ? std::make_shared<mhac_cache::EvaluationCache>(capacity) : nullptr;
+    }
+    mhac_cache::CacheStats evaluationCacheStats() const {
+        return evaluationCache ? evaluationCache->stats() : mhac_cache::CacheStats();
+    }
+
+    float evaluate(SolutionPtr sol) {
+        if (!evaluationCache)
+            return evaluateSolution(sol);
+
+        std::uint64_t key = sol->hash();
+        float cost;
+        if (evaluationCache->find(key, cost))
+            return cost;
+
+        cost = evaluateSolution(sol);
+        evaluationCache->insert(key, cost);
+        return cost;
+    }
+
+    mhac_cache::EvaluationCachePtr evaluationCache;
+
+    /**
+     * Optional stop condition, polled by the solvers once per iteration (an
+     * SA or TS step, a GA generation or island epoch, an ACO generation) with
+     * the best cost of the run so far. Once it returns true the solver stops
+     * and returns its best solution, e.g. for time or evaluation budgets.
+     */
+    void setStopCondition(std::function<bool(float)> condition) {
+        stopCondition = condition;
+    }
+    bool shouldStop(float bestCost) const {
+        return stopCondition && stopCondition(bestCost);
+    }
+
+    std::function<bool(float)> stopCondition;
 };
 using ProblemPtr = std::shared_ptr<Problem>;
 
@@ -61,6 +218,30 @@ public:
     float evaluateSolution(SolutionPtr sol) override {
         PYBIND11_OVERRIDE_PURE(float, Problem, evaluateSolution, sol);
     }
+    void improveSolution(SolutionPtr sol) override {
+        PYBIND11_OVERRIDE(void, Problem, improveSolution, sol);
+    }
+    bool supportsMoves() const override {
+        PYBIND11_OVERRIDE(bool, Problem, supportsMoves);
+    }
+    Move generateMove(SolutionPtr sol) override {
+        PYBIND11_OVERRIDE(Move, Problem, generateMove, sol);
+    }
+    float evaluateMove(SolutionPtr sol, const Move& move) override {
+        PYBIND11_OVERRIDE(float, Problem, evaluateMove, sol, move);
+    }
+    void applyMove(SolutionPtr sol, const Move& move) override {
+        PYBIND11_OVERRIDE(void, Problem, applyMove, sol, move);
+    }
+    void undoMove(SolutionPtr sol, const Move& move) override {
+        PYBIND11_OVERRIDE(void, Problem, undoMove, sol, move);
+    }
+    std::uint64_t hashAfterMove(SolutionPtr sol, std::uint64_t hash, const Move& move) override {
+        PYBIND11_OVERRIDE(std::uint64_t, Problem, hashAfterMove, sol, hash, move);
+    }
+    std::uint64_t moveAttribute(SolutionPtr sol, const Move& move) override {
+        PYBIND11_OVERRIDE(std::uint64_t, Problem, moveAttribute, sol, move);
+    }
 };
 using PyProblemPtr = std::shared_ptr<PyProblem>;
 
@@ -1,9 +1,14 @@
 #ifndef MHAC_EVOLUTIONARY_GA_HPP
 #define MHAC_EVOLUTIONARY_GA_HPP
 
+#include <vector>
+
 #include "common.hpp"
 #include "pybind11/pybind11.h"
 
+#include "evolutionary/Population.hpp"
+#include "evolutionary/Selection.hpp"
+
 namespace evolutionary
 {
 namespace GA
@@ -14,6 +19,20 @@ class Problem : virtual public common::Problem
 public:
     virtual common::SolutionVec crossover(common::SolutionPtr parent1, common::SolutionPtr parent2) = 0;
     virtual common::SolutionPtr mutation(common::SolutionPtr outChild, float mutationChance) = 0;
+
+    // Flat genomes: a problem whose solutions are genomeSize() ints is evolved
+    // on them in a Population, without a solution object per individual.
+    // The default of 0 goes through the solution methods above instead.
+    virtual int genomeSize() const { return 0; }
+    virtual void initialGenome(int* genome) {}
+    virtual void crossoverGenomes(const int* parent1, const int* parent2, int* child1, int* child2) {}
+    virtual void mutateGenome(int* genome, float mutationChance) {}
+    // the memetic step, like improveSolution
+    virtual void improveGenome(int* genome) {}
+    virtual float evaluateGenome(const int* genome) { return 0; }
+    // the key of a genome in the evaluation cache, the hash() of its solution
+    virtual std::uint64_t hashGenome(const int* genome) { return common::hashSequence(genome, genomeSize()); }
+    virtual common::SolutionPtr genomeSolution(const int* genome) { return nullptr; }
 };
 using ProblemPtr = std::shared_ptr<Problem>;
 
@@ -35,11 +54,11 @@ public:
 using PyProblemPtr = std::shared_ptr<PyProblem>;
 
 
-enum class SelectionType
+// where the islands of an island-model GA send their migrants
+enum class MigrationTopology
 {
-    TOURNAMENT,
-    PROPORTIONAL,
-    NUM_SELECTIONS
+    RING,               // island i to island i + 1, the last one to the first
+    FULLY_CONNECTED     // every island to every other one
 };
 
 class GeneticAlgorithm
@@ -55,13 +74,51 @@ public:
     
     common::SolutionPtr solve(int generations, int populationSize, float mutationChance, int selectionSize, SelectionType selectionType);
 
+    // the children of a generation are made on this many threads, 0 for one
+    // per hardware thread; the result does not depend on it
+    void setThreads(int threads);
+
+    // island model: islands populations of populationSize evolve on their own,
+    // each run on one thread, and every interval generations the migrants
+    // best individuals of each island replace the worst ones of its
+    // neighbours when they are better; 1 island is the plain GA
+    void setIslands(int islands, int interval, int migrants, MigrationTopology topology);
+
+    // steady state: instead of replacing the whole population every
+    // generation, each pair of children replaces the worst individuals right
+    // away when better, so the next parents can be picked among them; a
+    // generation is then populationSize / 2 such steps, made one at a time.
+    // Only tournament selection sees the replaced individuals, the others
+    // are built once per generation, so solve rejects them in steady state
+    void setSteadyState(bool enabled);
+
 private:
-    common::SolutionPtr tournamentSelection();
-    common::SolutionPtr proportionalSelection();
+    // evaluateGenome through the problem's evaluation cache, if any
+    float evaluate(const int* genome);
+    void initialize(Population& population, int k);
+    // makes children first and first + 1 (when it fits) of population from
+    // the parents 2 * pair and 2 * pair + 1 of selector
+    void breed(Population& population, const Selector& selector, int pair, int first, float mutationChance);
+    // pairs steps, step s drawing from stream firstStream + s of seed
+    void steadyStateGeneration(Population& population, const Selector& selector, std::vector<int>& worst, int pairs,
+                               unsigned long long seed, unsigned long long firstStream, float mutationChance);
+    void migrate();
+    // the island holding the best individual, the first of equal ones
+    int bestIsland() const;
 
-    common::SolutionVec mPopulation;
+    // one per island, every solve starts them over
+    std::vector<Population> mPopulations;
+    std::vector<Selector> mSelectors;
+    // the steady state replacement order of every island, a max-heap on cost
+    std::vector<std::vector<int>> mWorst;
+    Population mEmigrants;
     ProblemPtr mProblem;
-    int mSelectionSize;
+    int mThreads;
+    int mIslands;
+    int mMigrationInterval;
+    int mMigrants;
+    MigrationTopology mTopology;
+    bool mSteadyState;
 };
 
 } // namespace GA
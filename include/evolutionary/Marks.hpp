@@ -0,0 +1,40 @@
+#ifndef MHAC_EVOLUTIONARY_MARKS_HPP
+#define MHAC_EVOLUTIONARY_MARKS_HPP
+
+#include <algorithm>
+#include <vector>
+
+namespace evolutionary
+{
+namespace GA
+{
+
+// set of indexes in [0, n), e.g. genes or individuals, cleared in O(1) by
+// moving to the next epoch; internal to the crossovers and the selection
+class Marks
+{
+public:
+    void reset(int n)
+    {
+        if ((int) mStamps.size() < n)
+            mStamps.resize(n, 0);
+
+        if (++mEpoch == 0)
+        {
+            std::fill(mStamps.begin(), mStamps.end(), 0);
+            mEpoch = 1;
+        }
+    }
+
+    bool has(int index) const { return mStamps[index] == mEpoch; }
+    void add(int index) { mStamps[index] = mEpoch; }
+
+private:
+    std::vector<unsigned> mStamps;
+    unsigned mEpoch = 0;
+};
+
+} // namespace GA
+} // namespace evolutionary
+
+#endif // MHAC_EVOLUTIONARY_MARKS_HPP
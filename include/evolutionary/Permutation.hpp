@@ -0,0 +1,56 @@
+#ifndef MHAC_EVOLUTIONARY_PERMUTATION_HPP
+#define MHAC_EVOLUTIONARY_PERMUTATION_HPP
+
+#include <vector>
+
+namespace evolutionary
+{
+namespace GA
+{
+
+enum class CrossoverType
+{
+    ONE_POINT,          // one cut, then the repeated genes replaced by the missing ones
+    ORDER,              // OX
+    PARTIALLY_MAPPED,   // PMX
+    CYCLE,              // CX
+    EDGE_ASSEMBLY       // EAX, GA_TSP only, see problems/TSPEdgeAssembly.hpp
+};
+
+/**
+ * Crossovers of two permutations of 0..n-1 into two children, written in
+ * place: the children are n ints, or vectors resized to n, so nothing is
+ * allocated once they have the capacity. The genes already placed are
+ * tracked in per-thread arrays reused from call to call, nothing is hashed.
+ */
+
+// draws the cut points from mhac_random; EDGE_ASSEMBLY needs the instance
+// and throws std::invalid_argument here
+void permutationCrossover(CrossoverType type, const int* parent1, const int* parent2, int* child1, int* child2, int n);
+void permutationCrossover(CrossoverType type, const std::vector<int>& parent1, const std::vector<int>& parent2,
+                          std::vector<int>& child1, std::vector<int>& child2);
+
+// [0, cut) from one parent, the rest from the other, then repaired
+void onePointCrossover(const int* parent1, const int* parent2, int* child1, int* child2, int n, int cut);
+
+// [first, last) from one parent, the other positions from last on, wrapping
+// around, in the order the other parent has the remaining genes
+void orderCrossover(const int* parent1, const int* parent2, int* child1, int* child2, int n, int first, int last);
+
+// [first, last) from one parent, the other positions from the other parent
+// with the genes already in the segment mapped through it
+void partiallyMappedCrossover(const int* parent1, const int* parent2, int* child1, int* child2, int n, int first, int last);
+
+// the cycles of positions shared by the parents, taken from them in turn
+void cycleCrossover(const int* parent1, const int* parent2, int* child1, int* child2, int n);
+
+// makes genes a permutation of 0..n-1 again: the first occurrence of every
+// gene is kept and the missing genes, in increasing order, take the
+// places of the repeated ones from the first to the last
+void repairPermutation(int* genes, int n);
+void repairPermutation(std::vector<int>& genes);
+
+} // namespace GA
+} // namespace evolutionary
+
+#endif // MHAC_EVOLUTIONARY_PERMUTATION_HPP
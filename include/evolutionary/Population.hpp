@@ -0,0 +1,63 @@
+#ifndef MHAC_EVOLUTIONARY_POPULATION_HPP
+#define MHAC_EVOLUTIONARY_POPULATION_HPP
+
+#include <vector>
+
+#include "common.hpp"
+
+namespace evolutionary
+{
+namespace GA
+{
+
+/**
+ * Two generations of a GA, the population and the children being made
+ * from it; swap() turns the children into the population without copying.
+ *
+ * With a genome size, every individual is that many ints in one contiguous
+ * block per generation, with its cost in a float array next to it, so a run
+ * allocates nothing after reset. With a genome size of 0 the individuals
+ * are solution objects, for problems that have no flat genome.
+ */
+class Population
+{
+public:
+    void reset(int size, int genomeSize);
+    void swap() { mCurrent ^= 1; }
+
+    int size() const { return mSize; }
+    int genomeSize() const { return mGenomeSize; }
+    bool hasGenomes() const { return mGenomeSize > 0; }
+
+    float cost(int k) const { return mCosts[mCurrent][k]; }
+    float& childCost(int k) { return mCosts[mCurrent ^ 1][k]; }
+    const float* costs() const { return mCosts[mCurrent].data(); }
+
+    const int* genome(int k) const { return mGenomes[mCurrent].data() + (size_t) k * mGenomeSize; }
+    int* genome(int k) { return mGenomes[mCurrent].data() + (size_t) k * mGenomeSize; }
+    int* childGenome(int k) { return mGenomes[mCurrent ^ 1].data() + (size_t) k * mGenomeSize; }
+
+    const common::SolutionPtr& solution(int k) const { return mSolutions[mCurrent][k]; }
+    common::SolutionPtr& solution(int k) { return mSolutions[mCurrent][k]; }
+    common::SolutionPtr& childSolution(int k) { return mSolutions[mCurrent ^ 1][k]; }
+
+    // index of the cheapest individual, the first one on ties
+    int best() const;
+    // individual k of the population becomes a copy of individual j of from
+    void copy(int k, const Population& from, int j);
+    // individual k of the population becomes a copy of child j
+    void replace(int k, int j);
+
+private:
+    int mSize = 0;
+    int mGenomeSize = 0;
+    int mCurrent = 0;
+    std::vector<int> mGenomes[2];
+    std::vector<float> mCosts[2];
+    common::SolutionVec mSolutions[2];
+};
+
+} // namespace GA
+} // namespace evolutionary
+
+#endif // MHAC_EVOLUTIONARY_POPULATION_HPP
@@ -0,0 +1,70 @@
+#ifndef MHAC_EVOLUTIONARY_SELECTION_HPP
+#define MHAC_EVOLUTIONARY_SELECTION_HPP
+
+#include <vector>
+
+namespace evolutionary
+{
+namespace GA
+{
+
+enum class SelectionType
+{
+    TOURNAMENT,             // the best of selectionSize individuals, drawn without replacement
+    PROPORTIONAL,           // roulette wheel, weighing worst cost - cost
+    STOCHASTIC_UNIVERSAL,   // SUS, the same wheel with evenly spaced pointers, spun once per generation
+    RANK,                   // linear ranking, the best of n individuals weighs n and the worst 1
+    NUM_SELECTIONS
+};
+
+// Walker's alias method: sample() draws i with probability weights[i] / sum
+// in O(1), after an O(n) build; all weights 0 draw uniformly
+class AliasTable
+{
+public:
+    void build(const double* weights, int n);
+    int sample() const;
+
+private:
+    std::vector<double> mProbability;
+    std::vector<int> mAlias;
+    std::vector<int> mSmall;
+    std::vector<int> mLarge;
+};
+
+/**
+ * Picks the parents of a generation from the costs of a population, lower
+ * being better. build() does the O(n) or O(n log n) work once per
+ * generation, select() is then O(1), or O(selectionSize) for tournaments,
+ * and may be called from several threads at once.
+ *
+ * Tournaments read the costs at the time of the call, the other types the
+ * costs at build(). build() draws from mhac_random only for SUS.
+ */
+class Selector
+{
+public:
+    // costs must stay valid until the next build; picks is the number of
+    // parents SUS draws, select(pick) for pick in [0, picks)
+    void build(SelectionType type, const float* costs, int size, int selectionSize, int picks);
+
+    // index of parent number pick of the generation, only SUS needs pick
+    int select(int pick) const;
+
+private:
+    int tournament() const;
+
+    SelectionType mType = SelectionType::TOURNAMENT;
+    const float* mCosts = nullptr;
+    int mSize = 0;
+    int mSelectionSize = 0;
+    std::vector<double> mWeights;
+    std::vector<int> mOrder;
+    AliasTable mAlias;
+    std::vector<int> mPicks;
+};
+
+} // namespace GA
+} // namespace evolutionary
+
+#endif // MHAC_EVOLUTIONARY_SELECTION_HPP
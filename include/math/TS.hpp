@@ -1,6 +1,10 @@
 #ifndef MHAC_PHYSICS_TS_HPP
 #define MHAC_PHYSICS_TS_HPP
 
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
 #include "common.hpp"
 
 namespace math
@@ -8,6 +12,34 @@ namespace math
 namespace TS
 {
 
+enum class TabuMode
+{
+    SOLUTION,       // the latest solutions visited are tabu
+    ATTRIBUTE       // the attributes of the latest moves are tabu (Problem::moveAttribute), needs moves
+};
+
+/**
+ * The latest solutions visited, in a ring buffer with a count per hash, so
+ * checking a solution is O(1) once it is hashed. Solutions without a hash
+ * (Solution::hash() returns 0) are kept and compared with isEqual instead.
+ * Equal hashes are taken for equal solutions.
+ */
+class TabuList
+{
+public:
+    void reset(int capacity);
+    bool contains(const common::SolutionPtr&, std::uint64_t hash) const;
+    // sol is only kept when hash is 0, it must not change afterwards
+    void push(const common::SolutionPtr& sol, std::uint64_t hash);
+
+private:
+    std::vector<std::uint64_t> mHashes;
+    common::SolutionVec mSolutions;
+    int mNext = 0;
+    int mSize = 0;
+    std::unordered_map<std::uint64_t, int> mCounts;
+};
+
 class TabuSearch
 {
 public:
@@ -19,13 +51,26 @@ public:
     TabuSearch& operator=(TabuSearch&&) = delete;
     virtual ~TabuSearch() = default;
 
+    // in ATTRIBUTE mode maxTabuListSize is the tenure, the number of
+    // iterations a move's attribute stays tabu
     common::SolutionPtr solve(int iterations, int maxTabuListSize, int neighborhoodSize);
 
+    // throws std::invalid_argument from solve when ATTRIBUTE is set for a
+    // problem without moves
+    void setTabuMode(TabuMode mode);
+
 private:
-    bool inTabuList(const common::SolutionPtr&);
+    common::SolutionPtr solveWithMoves(int iterations, int maxTabuListSize, int neighborhoodSize);
+    // whether moving S, of the given hash, by move is tabu at iteration iter;
+    // after is the hash it would lead to in SOLUTION mode
+    bool isTabu(const common::SolutionPtr& S, std::uint64_t hash, const common::Move& move, int iter, std::uint64_t& after);
 
-    common::SolutionVec mTabuList;
+    TabuList mTabuList;
+    // the iteration until which every attribute made tabu stays so, the
+    // expired ones are dropped every tenure iterations
+    std::unordered_map<std::uint64_t, int> mTabuUntil;
     common::ProblemPtr mProblem;
+    TabuMode mMode;
 };
 
 } // namespace TS
@@ -0,0 +1,59 @@
+#ifndef MHAC_PARALLEL_HPP
+#define MHAC_PARALLEL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mhac_parallel
+{
+
+// threads to use when requested were asked for, 0 meaning one per hardware thread
+int threadCount(int requested);
+
+/**
+ * Fixed set of worker threads for loops whose iterations are independent.
+ * run(count, body) calls body(index) for every index in [0, count), spread
+ * over the workers and the calling thread, and returns once all are done.
+ * The first exception thrown by body is rethrown by run, the indexes not
+ * started yet are skipped.
+ */
+class ThreadPool
+{
+public:
+    // threads counts the calling thread, so threads - 1 workers are started
+    explicit ThreadPool(int threads);
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    int size() const { return mWorkers.size() + 1; }
+
+    void run(int count, const std::function<void(int)>& body);
+
+private:
+    void work();
+    void drain();
+
+    std::vector<std::thread> mWorkers;
+    std::mutex mMutex;
+    std::condition_variable mStart;
+    std::condition_variable mDone;
+
+    // the current run, set under mMutex before the workers are woken up
+    const std::function<void(int)>* mBody = nullptr;
+    int mCount = 0;
+    std::atomic<int> mNext{0};
+    int mActive = 0;
+    long long mRound = 0;
+    bool mStop = false;
+    std::exception_ptr mError;
+};
+
+} // namespace mhac_parallel
+
+#endif // MHAC_PARALLEL_HPP
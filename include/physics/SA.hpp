@@ -55,6 +55,7 @@ public:
     common::SolutionPtr solve(float maxT, float minT, float k);
 
 private:
+    common::SolutionPtr solveWithMoves(float maxT, float minT);
     float updateTemp(float T);
     bool accept(float currCost, float newCost, float T);
 
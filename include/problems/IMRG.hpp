@@ -0,0 +1,41 @@
+#ifndef MHAC_PROBLEMS_IMRG_HPP
+#define MHAC_PROBLEMS_IMRG_HPP
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "problems/JSS.hpp"
+
+namespace problems
+{
+namespace jss
+{
+
+/**
+ * Reader for the imrg testbeds (data/jss/imrg). A file holds "machines
+ * products" and then one row per product with its processing time on every
+ * machine, ds2 files end each row with the product's due date. The instance
+ * is named after the file without its extension, as in the best CSV files.
+ * Throws std::runtime_error on files it cannot read.
+ */
+Instance readIMRG(const std::string& path);
+
+// every .txt file of directory, sorted by name
+std::vector<Instance> readIMRGDirectory(const std::string& directory);
+
+// the Instance,Min rows of a best CSV file, instance name -> value
+std::map<std::string, long long> readIMRGBest(const std::string& path);
+
+// reads the file straight into a JSSP, GA_JSSP or ACO_JSSP
+template <typename JSSPType>
+std::shared_ptr<JSSPType> loadIMRG(const std::string& path)
+{
+    return std::make_shared<JSSPType>(readIMRG(path));
+}
+
+} // namespace jss
+} // namespace problems
+
+#endif // MHAC_PROBLEMS_IMRG_HPP
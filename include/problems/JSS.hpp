@@ -2,11 +2,13 @@
 #define MHAC_PROBLEMS_JSS_HPP
 
 #include <memory>
+#include <string>
 #include <vector>
 #include <cmath>
 
 #include "common.hpp"
 #include "evolutionary/GA.hpp"
+#include "evolutionary/Permutation.hpp"
 #include "swarm/ACO.hpp"
 
 namespace problems
@@ -17,29 +19,140 @@ namespace jss
 using ProductVec = std::vector<int>;
 using TimeMatrix = std::vector<ProductVec>; // size = N (products) * M (machines)
 
+/**
+ * Processing times of N products on M machines in one row-major array: the
+ * times of product j are at j * M .. j * M + M - 1.
+ */
+class ProcessingTimes
+{
+public:
+    ProcessingTimes() = default;
+    // implicit so a TimeMatrix still goes wherever ProcessingTimes are expected,
+    // throws std::invalid_argument unless every product has the same number of machines
+    ProcessingTimes(const TimeMatrix&);
+    ProcessingTimes(int products, int machines, const std::vector<int>& rowMajor);
+
+    int size() const { return mProducts; }
+    int machines() const { return mMachines; }
+
+    int operator()(int product, int machine) const { return mRows[(size_t) product * mMachines + machine]; }
+    const int* product(int product) const { return &mRows[(size_t) product * mMachines]; }
+
+    const std::vector<int>& data() const { return mRows; }
+    TimeMatrix toMatrix() const;
+
+private:
+    int mProducts = 0;
+    int mMachines = 0;
+    std::vector<int> mRows;
+};
+
+// a flow shop instance as read from a file, see problems/IMRG.hpp
+struct Instance
+{
+    std::string name;
+    ProcessingTimes products;
+    std::vector<int> dueDates;      // one per product, empty when the file has none
+};
+
 // Job-Shop Scheduling Solution
 class JSSS: public common::Solution
 {
 public:
     bool isEqual(const common::Solution&) const override;
+    common::SolutionPtr clone() const override;
     int getSize() const override;
+    std::uint64_t hash() const override;
     std::vector<int> schedule;
     std::string print();
+
+    // completion time of every position on every machine (flat, N x M) for
+    // completionSchedule, the move API rebuilds it whenever that is not schedule
+    std::vector<int> completionTimes;
+    std::vector<int> completionSchedule;
+    // hash() of schedule, kept through the move API; reset it when changing schedule otherwise
+    mutable common::StoredHash storedHash;
 };
 using JSSSPtr = std::shared_ptr<JSSS>;
 
+// moves made by the JSSP move API
+enum class Neighborhood
+{
+    SWAP,           // Move{i, j} swaps the jobs on positions i and j
+    INSERTION       // Move{i, j} takes the job on position i and reinserts it on position j
+};
+
+// how JSSP::constructSchedule builds a schedule
+enum class InitialSchedule
+{
+    RANDOM,
+    NEH             // jobs by decreasing total processing time, each inserted at its best position
+};
+
 // Job-Shop Scheduling Problem
 class JSSP: virtual public common::Problem
 {
 public:
     JSSP() = delete;
-    explicit JSSP(const TimeMatrix&);
-    
+    explicit JSSP(const ProcessingTimes&);
+    explicit JSSP(const Instance&);
+
+    // replaces the instance
+    void setProducts(const ProcessingTimes&);
+
+    // total completion time of schedule, row is scratch space for one int per machine
+    long long totalCompletionTime(const std::vector<int>& schedule, int* row) const;
+    long long totalCompletionTime(const int* schedule, int n, int* row) const;
+    // total completion time of a schedule of all the products
+    float evaluateSchedule(const int* schedule) const;
+
+    // a schedule built the given way, NEH scores its insertions like bestInsertion
+    std::vector<int> constructSchedule(InitialSchedule) const;
+
+    // builds the schedule once into seedSchedule, setProducts rebuilds it
+    void setInitialSchedule(InitialSchedule);
+
+    // a copy of seedSchedule with probability seedRatio, random otherwise;
+    // a ratio below 1 keeps some diversity in GA populations
     common::SolutionPtr generateInitialSolution() override;
     common::SolutionPtr generateNewSolution(common::SolutionPtr) override;
     float evaluateSolution(common::SolutionPtr) override;
-    
-    TimeMatrix products;
+
+    // moves of the selected neighborhood, scored from the completion times
+    // of the current schedule: only the positions from min(i, j) on are
+    // recomputed, and only until the delay caused by the move dies out
+    bool supportsMoves() const override { return true; }
+    common::Move generateMove(common::SolutionPtr) override;
+    float evaluateMove(common::SolutionPtr, const common::Move&) override;
+    void applyMove(common::SolutionPtr, const common::Move&) override;
+    void undoMove(common::SolutionPtr, const common::Move&) override;
+    // in O(|i - j|); a move's attribute is the pair of jobs swapped, or the
+    // job inserted elsewhere
+    std::uint64_t hashAfterMove(common::SolutionPtr, std::uint64_t hash, const common::Move&) override;
+    std::uint64_t moveAttribute(common::SolutionPtr, const common::Move&) override;
+
+    // position the job on position would best be moved to, with delta the
+    // resulting change of the total completion time (0 when it stays)
+    int bestInsertion(common::SolutionPtr, int position, float& delta);
+    // moves every job to its best position until none improves, returns the gain
+    float insertionLocalSearch(common::SolutionPtr);
+
+    // when enabled, improveSolution runs insertionLocalSearch
+    void setLocalSearch(bool enabled);
+    void improveSolution(common::SolutionPtr) override;
+
+    ProcessingTimes products;
+
+    Neighborhood neighborhood = Neighborhood::SWAP;
+    bool localSearch = false;
+
+    InitialSchedule initialSchedule = InitialSchedule::RANDOM;
+    float seedRatio = 1;
+    std::vector<int> seedSchedule;
+
+private:
+    void updateCompletionTimes(JSSS&) const;
+    void rearrange(JSSS&, const common::Move&, Neighborhood) const;
 };
 using JSSPPtr = std::shared_ptr<JSSP>;
 
@@ -48,11 +161,23 @@ class GA_JSSP : public evolutionary::GA::Problem, public JSSP
 {
 public:
     GA_JSSP() = delete;
-    explicit GA_JSSP(const TimeMatrix&);
+    explicit GA_JSSP(const ProcessingTimes&);
+    explicit GA_JSSP(const Instance&);
 
     common::SolutionVec crossover(common::SolutionPtr parent1, common::SolutionPtr parent2) override;
     common::SolutionPtr mutation(common::SolutionPtr outChild, float mutationChance) override;
     void repair(common::SolutionPtr);
+
+    // the GA evolves the schedules themselves, one int per product
+    int genomeSize() const override { return products.size(); }
+    void initialGenome(int* genome) override;
+    void crossoverGenomes(const int* parent1, const int* parent2, int* child1, int* child2) override;
+    void mutateGenome(int* genome, float mutationChance) override;
+    void improveGenome(int* genome) override;
+    float evaluateGenome(const int* genome) override;
+    common::SolutionPtr genomeSolution(const int* genome) override;
+
+    evolutionary::GA::CrossoverType crossoverType = evolutionary::GA::CrossoverType::ONE_POINT;
 };
 using GA_JSSPPtr = std::shared_ptr<GA_JSSP>;
 
@@ -61,10 +186,20 @@ class ACO_JSSP : public swarm::ACO::Problem, public JSSP
 {
 public:
     ACO_JSSP() = delete;
-    explicit ACO_JSSP(const TimeMatrix&);
+    explicit ACO_JSSP(const ProcessingTimes&);
+    explicit ACO_JSSP(const Instance&);
+
+    // 1 / total processing time of j, shorter jobs first
+    bool hasHeuristic() const override { return true; }
+    float heuristic(int i, int j) const override;
 
     common::SolutionPtr updateAntPath(common::SolutionPtr ant, swarm::ACO::PheromoneMatrixPtr pm, float alpha, float beta) override;
+
+    // tau = (1 - rho) * tau + rho * deposit, the deposit being weight / total
+    // completion time on every pair of consecutive jobs
     void updatePheromoneMatrix(common::SolutionPtr ant, swarm::ACO::PheromoneMatrixPtr pm, float rho) override;
+    bool depositsPheromone() const override { return true; }
+    void depositPheromone(common::SolutionPtr ant, swarm::ACO::PheromoneMatrix& pm, float weight) override;
 };
 using ACO_JSSPPtr = std::shared_ptr<ACO_JSSP>;
 
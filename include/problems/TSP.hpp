@@ -1,58 +1,250 @@
 #ifndef MHAC_PROBLEMS_TSP_HPP
 #define MHAC_PROBLEMS_TSP_HPP
 
+#include <atomic>
 #include <memory>
 #include <vector>
+#include <string>
 #include <cmath>
 
 #include "common.hpp"
 #include "evolutionary/GA.hpp"
+#include "evolutionary/Permutation.hpp"
 #include "swarm/ACO.hpp"
+#include "problems/TSPNeighbors.hpp"
+#include "problems/TSPTour.hpp"
+#include "problems/TSPLocalSearch.hpp"
+#include "problems/TSPEdgeAssembly.hpp"
 
 namespace problems
 {
 namespace tsp
 {
 
+// TSPLIB EDGE_WEIGHT_TYPE, EUCLIDEAN is the plain (unrounded) distance
+// used when cities are given directly instead of read from a TSPLIB file
+enum class EdgeWeightType
+{
+    EUCLIDEAN,
+    EUC_2D,
+    CEIL_2D,
+    ATT,
+    GEO,
+    EXPLICIT
+};
+
 struct City
 {
-    int x;
-    int y;
+    double x;
+    double y;
+
+    // the metric is picked by a switch on the type, EXPLICIT weights are not
+    // stored on cities and must be looked up through TSP::distance
+    inline float distance(const City& c, EdgeWeightType type = EdgeWeightType::EUCLIDEAN) const
+    {
+        double xdis = this->x - c.x;
+        double ydis = this->y - c.y;
+
+        switch (type)
+        {
+            case EdgeWeightType::EUC_2D:
+                return nint(std::sqrt(xdis*xdis + ydis*ydis));
+
+            case EdgeWeightType::CEIL_2D:
+                return std::ceil(std::sqrt(xdis*xdis + ydis*ydis));
 
-    inline float distance(const City& c) const
+            case EdgeWeightType::ATT:
+            {
+                double r = std::sqrt((xdis*xdis + ydis*ydis) / 10.0);
+                int t = nint(r);
+                return t < r ? t + 1 : t;
+            }
+
+            case EdgeWeightType::GEO:
+                return geoDistance(c);
+
+            default:
+                return std::sqrt(xdis*xdis + ydis*ydis);
+        }
+    }
+
+    static inline int nint(double d) { return (int) (d + 0.5); }
+
+    // x and y hold latitude and longitude in TSPLIB's DDD.MM format
+    inline float geoDistance(const City& c) const
     {
-        int xdis = this->x - c.x;
-        int ydis = this->y - c.y;
-        return sqrt(xdis*xdis + ydis*ydis);
+        const double PI = 3.141592;
+        const double RRR = 6378.388;
+
+        auto radians = [PI](double coord) {
+            int deg = (int) coord;
+            return PI * (deg + 5.0 * (coord - deg) / 3.0) / 180.0;
+        };
+
+        double q1 = std::cos(radians(this->y) - radians(c.y));
+        double q2 = std::cos(radians(this->x) - radians(c.x));
+        double q3 = std::cos(radians(this->x) + radians(c.x));
+        return (int) (RRR * std::acos(0.5 * ((1.0 + q1) * q2 - (1.0 - q1) * q3)) + 1.0);
     }
 };
 using Cities = std::vector<City>;
 
+// a problem instance as read from a TSPLIB file, see problems/TSPLIB.hpp
+struct Instance
+{
+    std::string name;
+    EdgeWeightType edgeWeightType = EdgeWeightType::EUCLIDEAN;
+    Cities cities;                  // display coordinates (or zeros) for EXPLICIT instances
+    std::vector<int> weights;       // full n*n matrix, EXPLICIT instances only
+};
+
 
 // Traveling Salesman Solution
 class TSS: public common::Solution
 {
 public:
     bool isEqual(const common::Solution&) const override;
+    common::SolutionPtr clone() const override;
     int getSize() const override;
+    std::uint64_t hash() const override;
     std::vector<int> tour;
     std::string print();
+
+    // position of every city in tour, only kept up to date by the move API
+    std::vector<int> positions;
+    // hash() of tour, kept through the move API; reset it when changing tour otherwise
+    mutable common::StoredHash storedHash;
 };
 using TSSPtr = std::shared_ptr<TSS>;
 
 
+// Traveling Salesman Solution on a two-level list, reversals cost O(sqrt(n))
+// instead of O(n) which pays off on large instances
+class LinkedTSS: public common::Solution
+{
+public:
+    bool isEqual(const common::Solution&) const override;
+    common::SolutionPtr clone() const override;
+    int getSize() const override;
+    std::uint64_t hash() const override;
+    std::string print();
+
+    // conversions to and from the plain city order, the one Python sees
+    std::vector<int> getTour() const;
+    void setTour(const std::vector<int>&);
+
+    // hash() of tour, kept through the move API; setTour resets it, as must
+    // anything else changing tour
+    mutable common::StoredHash storedHash;
+
+    TwoLevelList tour;
+};
+using LinkedTSSPtr = std::shared_ptr<LinkedTSS>;
+
+// representation of the solutions made by TSP::generateInitialSolution
+enum class TourType
+{
+    ARRAY,              // TSS
+    TWO_LEVEL_LIST      // LinkedTSS
+};
+
+// how TSP::constructTour builds a tour, see problems/TSPConstruction.hpp
+enum class InitialTour
+{
+    RANDOM,
+    NEAREST_NEIGHBOR,       // from a random start city
+    GREEDY,
+    SPACE_FILLING_CURVE
+};
+
+
 // Traveling Salesman Problem
 class TSP: virtual public common::Problem
 {
 public:
     TSP() = delete;
     explicit TSP(const Cities&);
+    explicit TSP(const Instance&);
+
+    // replaces the instance, dropping anything derived from the old cities
+    void setCities(const Cities&);
+
+    inline float distance(int a, int b) const
+    {
+        if (edgeWeightType == EdgeWeightType::EXPLICIT)
+            return weights[(size_t) a * cities.size() + b];
+        return cities[a].distance(cities[b], edgeWeightType);
+    }
+
+    // k nearest neighbours of every city (plus quadrantK per quadrant), once
+    // built, moves and ant construction are restricted to these candidate edges
+    void buildNeighborLists(int k, int quadrantK = 0);
+    NeighborLists makeNeighborLists(int k, int quadrantK = 0) const;
+
+    // when enabled, improveSolution runs the 2-opt + Or-opt local search
+    void setLocalSearch(bool enabled, int k = 10);
+    void improveSolution(common::SolutionPtr) override;
     
+    // a tour built the given way, wrapped in a solution of tourType
+    std::vector<int> constructTour(InitialTour) const;
+    common::SolutionPtr constructSolution(InitialTour) const;
+
+    // sets initialTour; the GREEDY and SPACE_FILLING_CURVE tours are the same
+    // every time, so they are built once into seedTour, which setCities and
+    // buildNeighborLists rebuild. NEAREST_NEIGHBOR starts from a random city
+    // and is still built for every solution
+    void setInitialTour(InitialTour);
+
+    // initialTour, with probability seedRatio, random otherwise; a ratio
+    // below 1 keeps some diversity in GA populations
     common::SolutionPtr generateInitialSolution() override;
     common::SolutionPtr generateNewSolution(common::SolutionPtr) override;
     float evaluateSolution(common::SolutionPtr) override;
+    // length of a tour of all the cities, not counted in evaluations
+    float evaluateTour(const int* tour) const;
+
+    // 2-opt moves, Move{i, j} reverses the tour between positions i and j (i <= j),
+    // on a LinkedTSS it reverses the path going forward from city i to city j
+    // with neighbor lists, the move always links a city to one of its candidates
+    bool supportsMoves() const override { return true; }
+    common::Move generateMove(common::SolutionPtr) override;
+    float evaluateMove(common::SolutionPtr, const common::Move&) override;
+    void applyMove(common::SolutionPtr, const common::Move&) override;
+    void undoMove(common::SolutionPtr, const common::Move&) override;
+    // in O(1), from the four edges the move swaps; a move's attribute is the
+    // pair of cities at the ends of the path it reverses
+    std::uint64_t hashAfterMove(common::SolutionPtr, std::uint64_t hash, const common::Move&) override;
+    std::uint64_t moveAttribute(common::SolutionPtr, const common::Move&) override;
     
     Cities cities;
+    EdgeWeightType edgeWeightType = EdgeWeightType::EUCLIDEAN;
+    std::vector<int> weights;
+    // the coordinates again as separate arrays, read by the tour length
+    // kernel; kept in sync by the constructors and setCities
+    std::vector<double> xs;
+    std::vector<double> ys;
+    NeighborLists neighbors;
+    LocalSearchPtr localSearch;
+
+    // every TSP method handles both representations, the GA_TSP and
+    // ACO_TSP operators only work on TSS
+    TourType tourType = TourType::ARRAY;
+
+    InitialTour initialTour = InitialTour::RANDOM;
+    float seedRatio = 1;
+    std::vector<int> seedTour;
+
+    // calls to evaluateSolution and evaluateMove so far, for benchmarks
+    std::atomic<long long> evaluations{0};
+    std::atomic<long long> moveEvaluations{0};
+
+protected:
+    // initialTour's tour with probability seedRatio, a random one otherwise
+    std::vector<int> seededTour() const;
+
+private:
+    void splitCoordinates();
+    common::SolutionPtr solutionOf(std::vector<int> tour) const;
 };
 using TSPPtr = std::shared_ptr<TSP>;
 
@@ -63,10 +255,26 @@ class GA_TSP : public evolutionary::GA::Problem, public TSP
 public:
     GA_TSP() = delete;
     explicit GA_TSP(const Cities&);
+    explicit GA_TSP(const Instance&);
 
     common::SolutionVec crossover(common::SolutionPtr parent1, common::SolutionPtr parent2) override;
     common::SolutionPtr mutation(common::SolutionPtr outChild, float mutationChance) override;
     void repair(common::SolutionPtr) ;
+    // when enabled, crossover uses EAX with that many AB-cycles tried per child
+    void setEdgeAssembly(bool enabled, int trials = 30, int k = 10);
+
+    // the GA evolves the tours themselves, one int per city
+    int genomeSize() const override { return cities.size(); }
+    void initialGenome(int* genome) override;
+    void crossoverGenomes(const int* parent1, const int* parent2, int* child1, int* child2) override;
+    void mutateGenome(int* genome, float mutationChance) override;
+    void improveGenome(int* genome) override;
+    float evaluateGenome(const int* genome) override;
+    std::uint64_t hashGenome(const int* genome) override;
+    common::SolutionPtr genomeSolution(const int* genome) override;
+
+    evolutionary::GA::CrossoverType crossoverType = evolutionary::GA::CrossoverType::ONE_POINT;
+    EdgeAssemblyPtr edgeAssembly;
 };
 using GA_TSPPtr = std::shared_ptr<GA_TSP>;
 
@@ -77,9 +285,23 @@ class ACO_TSP : public swarm::ACO::Problem, public TSP
 public:
     ACO_TSP() = delete;
     explicit ACO_TSP(const Cities&);
+    explicit ACO_TSP(const Instance&);
+
+    // 1 / distance, 0 between cities at the same place
+    bool hasHeuristic() const override { return true; }
+    float heuristic(int i, int j) const override;
+    // TSPLIB .tsp instances, explicit ones included, are symmetric
+    bool isSymmetric() const override { return true; }
+    // the neighbor lists, once built
+    bool candidateLists(std::vector<int>& offsets, std::vector<int>& candidates) const override;
 
     common::SolutionPtr updateAntPath(common::SolutionPtr ant, swarm::ACO::PheromoneMatrixPtr pm, float alpha, float beta) override;
+
+    // tau = (1 - rho) * tau + rho * deposit, the deposit being weight / tour
+    // length on every edge of the tour
     void updatePheromoneMatrix(common::SolutionPtr ant, swarm::ACO::PheromoneMatrixPtr pm, float rho) override;
+    bool depositsPheromone() const override { return true; }
+    void depositPheromone(common::SolutionPtr ant, swarm::ACO::PheromoneMatrix& pm, float weight) override;
 };
 using ACO_TSPPtr = std::shared_ptr<ACO_TSP>;
 
@@ -0,0 +1,31 @@
+#ifndef MHAC_PROBLEMS_TSP_CONSTRUCTION_HPP
+#define MHAC_PROBLEMS_TSP_CONSTRUCTION_HPP
+
+#include <vector>
+
+namespace problems
+{
+namespace tsp
+{
+
+class TSP;
+
+// Construction heuristics for initial tours, see TSP::constructTour.
+// For GEO and EXPLICIT instances the coordinates don't order the distances,
+// the k-d tree searches are replaced by O(n^2) scans there.
+
+// always moves on to the closest city not visited yet, O(n log n) on average
+std::vector<int> nearestNeighborTour(const TSP&, int start);
+
+// shortest candidate edges first, skipping the ones that would give a city
+// a third edge or close a cycle; the fragments left are chained nearest
+// endpoint first
+std::vector<int> greedyTour(const TSP&);
+
+// cities in the order of a Hilbert curve over the coordinates, O(n log n)
+std::vector<int> spaceFillingCurveTour(const TSP&);
+
+} // namespace tsp
+} // namespace problems
+
+#endif // MHAC_PROBLEMS_TSP_CONSTRUCTION_HPP
@@ -0,0 +1,56 @@
+#ifndef MHAC_PROBLEMS_TSP_EDGE_ASSEMBLY_HPP
+#define MHAC_PROBLEMS_TSP_EDGE_ASSEMBLY_HPP
+
+#include <memory>
+#include <vector>
+
+#include "problems/TSPNeighbors.hpp"
+
+namespace problems
+{
+namespace tsp
+{
+
+class TSP;
+
+/**
+ * Edge assembly crossover (EAX, Nagata and Kobayashi), one AB-cycle at a
+ * time. The edges the parents don't share are split into AB-cycles, taking
+ * an edge of parent1 and one of parent2 in turn. An offspring is parent1
+ * with the parent1 edges of one AB-cycle replaced by its parent2 edges,
+ * which leaves sub-tours; the smallest one is merged into another by the
+ * cheapest 2-exchange reaching one of its cities' candidates, until a
+ * single tour is left.
+ *
+ * Offspring are only scored: parent1 is cut into segments at the removed
+ * edges, sub-tours are chains of segments and every change is undone, so a
+ * trial costs the size of its AB-cycle and sub-tours, not n. Only the best
+ * one is written out. The scratch state is per thread and reused between
+ * calls, so one EdgeAssembly can be shared by several threads.
+ */
+class EdgeAssembly
+{
+public:
+    // the candidates are the problem's neighbor lists when built, its own
+    // k nearest neighbours otherwise
+    explicit EdgeAssembly(const TSP&, int trials = 30, int k = 10);
+
+    // writes to child the best of up to trials offspring, each from a
+    // different AB-cycle, parent1 itself when the parents have the same
+    // edges; returns the child's length minus parent1's
+    double cross(const std::vector<int>& parent1, const std::vector<int>& parent2, std::vector<int>& child) const;
+    double cross(const int* parent1, const int* parent2, int* child, int n) const;
+
+    int getTrials() const { return mTrials; }
+
+private:
+    const TSP& mProblem;
+    NeighborLists mNeighbors;
+    int mTrials;
+};
+using EdgeAssemblyPtr = std::shared_ptr<EdgeAssembly>;
+
+} // namespace tsp
+} // namespace problems
+
+#endif // MHAC_PROBLEMS_TSP_EDGE_ASSEMBLY_HPP
@@ -0,0 +1,29 @@
+#ifndef MHAC_PROBLEMS_TSP_KERNELS_HPP
+#define MHAC_PROBLEMS_TSP_KERNELS_HPP
+
+namespace problems
+{
+namespace tsp
+{
+
+enum class EdgeWeightType;
+
+/**
+ * Length of the closed tour over cities given as separate x and y arrays.
+ * Every edge is rounded exactly like City::distance (including the final
+ * conversion to float) and summed in double, so the result only differs from
+ * an edge by edge sum by the order of the additions, which is exact for the
+ * rounded TSPLIB metrics.
+ *
+ * Handles EUCLIDEAN, EUC_2D, CEIL_2D and ATT. The AVX-512 or AVX2 version is
+ * picked at runtime when the cpu has it, with a scalar loop otherwise.
+ */
+double tourLength(const double* x, const double* y, const int* tour, int n, EdgeWeightType type);
+
+// true when tourLength handles the metric
+bool hasTourLengthKernel(EdgeWeightType type);
+
+} // namespace tsp
+} // namespace problems
+
+#endif // MHAC_PROBLEMS_TSP_KERNELS_HPP
@@ -0,0 +1,35 @@
+#ifndef MHAC_PROBLEMS_TSPLIB_HPP
+#define MHAC_PROBLEMS_TSPLIB_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "problems/TSP.hpp"
+
+namespace problems
+{
+namespace tsp
+{
+
+/**
+ * TSPLIB reader, supports the EUC_2D, CEIL_2D, ATT, GEO and EXPLICIT edge
+ * weight types (FULL_MATRIX and every triangular EDGE_WEIGHT_FORMAT).
+ * Throws std::runtime_error on files it cannot read.
+ */
+Instance readTSPLIB(const std::string& path);
+
+// TSPLIB .tour file (e.g. the .opt.tour ones), cities numbered from 0
+std::vector<int> readTSPLIBTour(const std::string& path);
+
+// reads the file straight into a TSP, GA_TSP or ACO_TSP
+template <typename TSPType>
+std::shared_ptr<TSPType> loadTSPLIB(const std::string& path)
+{
+    return std::make_shared<TSPType>(readTSPLIB(path));
+}
+
+} // namespace tsp
+} // namespace problems
+
+#endif // MHAC_PROBLEMS_TSPLIB_HPP
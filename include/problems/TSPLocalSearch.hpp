@@ -0,0 +1,56 @@
+#ifndef MHAC_PROBLEMS_TSP_LOCAL_SEARCH_HPP
+#define MHAC_PROBLEMS_TSP_LOCAL_SEARCH_HPP
+
+#include <memory>
+#include <vector>
+
+#include "problems/TSPNeighbors.hpp"
+
+namespace problems
+{
+namespace tsp
+{
+
+class TSP;
+class TwoLevelList;
+
+/**
+ * 2-opt + Or-opt (segments of 1 to 3 cities, both orientations) run to a
+ * local optimum. Only candidate edges from the neighbor lists are tried and
+ * don't-look bits keep the search on the cities around the last improvement.
+ *
+ * The instance is bound at construction: it uses the problem's neighbor
+ * lists when they are built, its own k nearest neighbours otherwise.
+ * improve() keeps all its scratch state local, so one LocalSearch can be
+ * shared by several threads.
+ */
+class LocalSearch
+{
+public:
+    explicit LocalSearch(const TSP&, int k = 10);
+
+    // improves tour in place, returns by how much the tour length decreased
+    double improve(std::vector<int>& tour) const;
+    double improve(TwoLevelList& tour) const;
+
+private:
+    template <typename Tour>
+    double run(Tour&) const;
+
+    // both try the moves around city a, apply the first improving one and
+    // append its endpoints to touched
+    template <typename Tour>
+    bool twoOpt(Tour&, int a, double& gain, std::vector<int>& touched) const;
+
+    template <typename Tour>
+    bool orOpt(Tour&, int a, double& gain, std::vector<int>& touched) const;
+
+    const TSP& mProblem;
+    NeighborLists mNeighbors;
+};
+using LocalSearchPtr = std::shared_ptr<LocalSearch>;
+
+} // namespace tsp
+} // namespace problems
+
+#endif // MHAC_PROBLEMS_TSP_LOCAL_SEARCH_HPP
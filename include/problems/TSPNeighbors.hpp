@@ -0,0 +1,84 @@
+#ifndef MHAC_PROBLEMS_TSP_NEIGHBORS_HPP
+#define MHAC_PROBLEMS_TSP_NEIGHBORS_HPP
+
+#include <vector>
+#include <functional>
+
+namespace problems
+{
+namespace tsp
+{
+
+struct City;
+using Cities = std::vector<City>;
+
+/**
+ * Static 2d tree over the city coordinates, built once in O(n log n).
+ * The tree is implicit: every range [begin, end) of mIndex is split around its
+ * middle element on the axis with the larger spread, so no nodes are stored.
+ */
+class KDTree
+{
+public:
+    explicit KDTree(const Cities&);
+
+    // indexes of the (at most) k cities closest to city, closest first, city excluded
+    // quadrant 0..3 restricts the search to (x >= cx) + 2 * (y >= cy), -1 searches everywhere
+    std::vector<int> nearest(int city, int k, int quadrant = -1) const;
+
+    // for tours built by repeatedly going to the closest city not taken yet:
+    // remove() takes a city out of nearestRemaining(), which returns the closest
+    // remaining city (city excluded) or -1, skipping subtrees left empty
+    void remove(int city);
+    int nearestRemaining(int city) const;
+
+private:
+    struct Candidate
+    {
+        double dist;
+        int city;
+        bool operator<(const Candidate& c) const { return dist < c.dist; }
+    };
+
+    void build(int begin, int end);
+    void search(int begin, int end, int city, int k, int quadrant, std::vector<Candidate>& heap) const;
+    bool inQuadrant(int city, int other, int quadrant) const;
+    void searchRemaining(int begin, int end, int city, Candidate& best) const;
+
+    std::vector<double> mX;
+    std::vector<double> mY;
+    std::vector<int> mIndex;
+    std::vector<char> mAxis; // split axis of the range whose middle element sits at that position
+    std::vector<int> mPosition; // position of every city in mIndex
+    std::vector<int> mRemaining; // cities not removed in the range whose middle element sits at that position
+    std::vector<char> mRemoved;
+};
+
+/**
+ * Candidate lists, for every city the indexes of its nearest neighbours
+ * (plus, optionally, the nearest ones in each quadrant), closest first.
+ * Stored flat with offsets since quadrant neighbours make the lists uneven.
+ */
+class NeighborLists
+{
+public:
+    NeighborLists() = default;
+    NeighborLists(const Cities&, int k, int quadrantK = 0);
+    // O(n^2) construction from a distance function, for metrics without usable coordinates
+    NeighborLists(int n, int k, const std::function<float(int, int)>& distance);
+
+    const int* begin(int city) const { return mNeighbors.data() + mOffsets[city]; }
+    const int* end(int city) const { return mNeighbors.data() + mOffsets[city + 1]; }
+    int size(int city) const { return mOffsets[city + 1] - mOffsets[city]; }
+    std::vector<int> of(int city) const { return std::vector<int>(begin(city), end(city)); }
+    bool empty() const { return mNeighbors.empty(); }
+
+private:
+    std::vector<int> mOffsets;
+    std::vector<int> mNeighbors;
+};
+
+} // namespace tsp
+} // namespace problems
+
+#endif // MHAC_PROBLEMS_TSP_NEIGHBORS_HPP
@@ -0,0 +1,193 @@
+#ifndef MHAC_PROBLEMS_TSP_TOUR_HPP
+#define MHAC_PROBLEMS_TSP_TOUR_HPP
+
+#include <vector>
+
+namespace problems
+{
+namespace tsp
+{
+
+/**
+ * Tour kept as a city array plus the position of every city, so next/prev
+ * and between are O(1). reverse(from, to) reverses the forward path from..to
+ * or, when that is shorter, its complement, both give the same cycle.
+ */
+class ArrayTour
+{
+public:
+    ArrayTour() = default;
+    explicit ArrayTour(const std::vector<int>& tour) { set(tour); }
+
+    void set(const std::vector<int>& tour)
+    {
+        mTour = tour;
+        mPositions.resize(tour.size());
+        for (int i = 0; i < (int) tour.size(); i++)
+            mPositions[tour[i]] = i;
+    }
+
+    void get(std::vector<int>& tour) const { tour = mTour; }
+
+    int size() const { return mTour.size(); }
+
+    int next(int city) const
+    {
+        int i = mPositions[city] + 1;
+        return mTour[i == (int) mTour.size() ? 0 : i];
+    }
+
+    int prev(int city) const
+    {
+        int i = mPositions[city];
+        return mTour[i == 0 ? mTour.size() - 1 : i - 1];
+    }
+
+    // true when b is met going forward from a before reaching c (a and c included)
+    bool between(int a, int b, int c) const
+    {
+        int n = mTour.size();
+        int pa = mPositions[a];
+        return (mPositions[b] - pa + n) % n <= (mPositions[c] - pa + n) % n;
+    }
+
+    void reverse(int from, int to)
+    {
+        int n = mTour.size();
+        int i = mPositions[from];
+        int j = mPositions[to];
+        int length = (j - i + n) % n + 1;
+
+        if (2 * length > n)
+        {
+            int complementFrom = (j + 1) % n;
+            j = (i - 1 + n) % n;
+            i = complementFrom;
+            length = n - length;
+        }
+
+        for (int k = 0; k < length / 2; k++)
+        {
+            int a = mTour[i];
+            int b = mTour[j];
+            mTour[i] = b;
+            mPositions[b] = i;
+            mTour[j] = a;
+            mPositions[a] = j;
+            i = (i + 1 == n) ? 0 : i + 1;
+            j = (j == 0) ? n - 1 : j - 1;
+        }
+    }
+
+private:
+    std::vector<int> mTour;
+    std::vector<int> mPositions;
+};
+
+/**
+ * Two-level list: the tour is cut into about sqrt(n) segments kept in a
+ * circular doubly-linked list, each segment holding its cities contiguously
+ * with a reversed bit. next/prev/between are O(1), reverse is O(sqrt(n)):
+ * the path is split on segment boundaries and the segments in between are
+ * relinked in the opposite order with their reversed bits toggled.
+ *
+ * Unlike ArrayTour, reverse(from, to) always reverses the path itself and
+ * never its complement, so the direction of the rest of the tour is kept
+ * and reverse(to, from) undoes it.
+ */
+class TwoLevelList
+{
+public:
+    TwoLevelList() = default;
+    explicit TwoLevelList(const std::vector<int>& tour) { set(tour); }
+
+    void set(const std::vector<int>& tour);
+    void get(std::vector<int>& tour) const;
+
+    int size() const { return mSegmentOf.size(); }
+
+    int next(int city) const
+    {
+        const Segment& s = mSegments[mSegmentOf[city]];
+        int i = mIndexOf[city];
+        if (!s.reversed)
+            return i + 1 < (int) s.cities.size() ? s.cities[i + 1] : first(s.next);
+        return i > 0 ? s.cities[i - 1] : first(s.next);
+    }
+
+    int prev(int city) const
+    {
+        const Segment& s = mSegments[mSegmentOf[city]];
+        int i = mIndexOf[city];
+        if (!s.reversed)
+            return i > 0 ? s.cities[i - 1] : last(s.prev);
+        return i + 1 < (int) s.cities.size() ? s.cities[i + 1] : last(s.prev);
+    }
+
+    // true when b is met going forward from a before reaching c (a and c included)
+    bool between(int a, int b, int c) const
+    {
+        long long ka = key(a), kb = key(b), kc = key(c);
+        if (ka <= kc)
+            return ka <= kb && kb <= kc;
+        return kb >= ka || kb <= kc;
+    }
+
+    void reverse(int from, int to);
+
+private:
+    struct Segment
+    {
+        std::vector<int> cities;
+        bool reversed = false;
+        int rank = 0;
+        int next = 0;
+        int prev = 0;
+    };
+
+    int first(int segment) const
+    {
+        const Segment& s = mSegments[segment];
+        return s.reversed ? s.cities.back() : s.cities.front();
+    }
+
+    int last(int segment) const
+    {
+        const Segment& s = mSegments[segment];
+        return s.reversed ? s.cities.front() : s.cities.back();
+    }
+
+    // index of the city counted in tour direction inside its segment
+    int orientedIndex(int city) const
+    {
+        const Segment& s = mSegments[mSegmentOf[city]];
+        return s.reversed ? s.cities.size() - 1 - mIndexOf[city] : mIndexOf[city];
+    }
+
+    // position in tour order starting from the head segment
+    long long key(int city) const
+    {
+        return (long long) mSegments[mSegmentOf[city]].rank * mSegmentOf.size() + orientedIndex(city);
+    }
+
+    void reverseInSegment(int from, int to);
+    void reverseSegments(int firstSegment, int lastSegment);
+    int split(int segment, int at);
+    void merge(int segment);
+    void assign(int segment, std::vector<int>& cities);
+    void renumber();
+    int newSegment();
+
+    std::vector<Segment> mSegments;
+    std::vector<int> mFreeSegments;
+    std::vector<int> mSegmentOf;
+    std::vector<int> mIndexOf;
+    int mHead = 0;
+    int mSegmentCount = 0;
+    int mGroupSize = 1;
+};
+
+} // namespace tsp
+} // namespace problems
+
+#endif // MHAC_PROBLEMS_TSP_TOUR_HPP
@@ -8,8 +8,17 @@ namespace mhac_random
 {
 
 float random(float start = 0, float end = 1);
+int randint(int start, int end);  // [start, end]
 std::vector<int> sample(int range_size, int count);
 
+// reseeds the generator of the calling thread, every draw above uses it
+void seed(unsigned value);
+
+// reseeds it with stream number stream of value: work split over threads
+// draws the same numbers when each item seeds its own stream, whichever
+// thread it runs on
+void seedStream(unsigned long long value, unsigned long long stream);
+
 } // namespace mhac_random
 
 #endif // MHAC_RANDOM_HPP
\ No newline at end of file
@@ -1,7 +1,12 @@
 #ifndef MHAC_SWARM_ACO_HPP
 #define MHAC_SWARM_ACO_HPP
 
+#include <algorithm>
+#include <cstdlib>
 #include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 #include "common.hpp"
@@ -12,35 +17,210 @@ namespace swarm
 namespace ACO
 {
 
+// std::allocator with storage aligned to Alignment bytes
+template <typename T, size_t Alignment>
+struct AlignedAllocator
+{
+    using value_type = T;
+    template <typename U> struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() = default;
+    template <typename U> AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(size_t n)
+    {
+        void* p = nullptr;
+        if (posix_memalign(&p, Alignment, std::max<size_t>(n * sizeof(T), 1)) != 0)
+            throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, size_t) { free(p); }
+
+    template <typename U> bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+    template <typename U> bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+enum class PheromoneLayout
+{
+    DENSE,          // n x n, every row starting on a cache line
+    SYMMETRIC,      // lower triangle, (i, j) and (j, i) are the same entry
+    SPARSE          // only the candidate edges of every row, the other pairs share one default value
+};
+
+/**
+ * Pheromone on every pair, stored as one flat array of entries in the given
+ * layout. Entries are reached through index(i, j), so evaporation and
+ * caches over the whole matrix (ChoiceInfo) can walk values() directly.
+ * Pairs a SPARSE matrix does not store read as the default value and
+ * throw std::out_of_range when written.
+ */
 class PheromoneMatrix
 {
 public:
-    PheromoneMatrix(int size, float initialValue);
+    using Values = std::vector<float, AlignedAllocator<float, 64>>;
+
+    PheromoneMatrix(int size, float initialValue, PheromoneLayout layout = PheromoneLayout::DENSE);
+    // SPARSE, the stored entries of row i are (i, candidates[offsets[i]..offsets[i + 1]))
+    PheromoneMatrix(float initialValue, const std::vector<int>& offsets, const std::vector<int>& candidates);
 
     float& operator()(int i, int j) {
-        return matrix_[i][j];
+        long long k = index(i, j);
+        if (k < 0)
+            throw std::out_of_range("pair (" + std::to_string(i) + ", " + std::to_string(j) + ") is not stored by the sparse pheromone matrix");
+        return values_[k];
     }
 
     const float& operator()(int i, int j) const {
-        return matrix_[i][j];
+        long long k = index(i, j);
+        return k < 0 ? defaultValue_ : values_[k];
+    }
+
+    // position of (i, j) in values(), -1 for a pair that is not stored
+    long long index(int i, int j) const {
+        switch (layout_)
+        {
+            case PheromoneLayout::DENSE:
+                return (long long) i * stride_ + j;
+            case PheromoneLayout::SYMMETRIC:
+                return i >= j ? (long long) i * (i + 1) / 2 + j : (long long) j * (j + 1) / 2 + i;
+            default:
+                for (int k = offsets_[i]; k < offsets_[i + 1]; k++)
+                    if (candidates_[k] == j)
+                        return k;
+                return -1;
+        }
+    }
+
+    // calls f(i, j, k) for every stored entry k, once per entry: a SYMMETRIC
+    // matrix only gives the pairs with j <= i
+    template <typename F>
+    void forEach(F f) const {
+        for (int i = 0; i < size_; i++) {
+            if (layout_ == PheromoneLayout::SPARSE) {
+                for (int k = offsets_[i]; k < offsets_[i + 1]; k++)
+                    f(i, candidates_[k], (long long) k);
+            } else {
+                int end = layout_ == PheromoneLayout::DENSE ? size_ : i + 1;
+                for (int j = 0; j < end; j++)
+                    f(i, j, index(i, j));
+            }
+        }
     }
 
+    // multiplies every value, the default included
+    void scale(float factor);
+    // sets every value, the default included
+    void fill(float value);
+    // keeps every value, the default included, within [low, high]
+    void clamp(float low, float high);
+    // adds amount to (i, j), pairs that are not stored are left at the default
+    void add(int i, int j, float amount);
+
     int getSize() const {
         return size_;
     }
 
+    PheromoneLayout getLayout() const {
+        return layout_;
+    }
+
+    float getDefault() const {
+        return defaultValue_;
+    }
+
+    void setDefault(float value) {
+        defaultValue_ = value;
+    }
+
+    // the stored entries, padding of DENSE rows included
+    Values& values() {
+        return values_;
+    }
+
+    const Values& values() const {
+        return values_;
+    }
+
 private:
     int size_;
-    std::vector<std::vector<float>> matrix_;
+    PheromoneLayout layout_;
+    long long stride_;
+    float defaultValue_;
+    Values values_;
+    std::vector<int> offsets_;
+    std::vector<int> candidates_;
 };
 using PheromoneMatrixPtr = std::shared_ptr<PheromoneMatrix>;
 
+class Problem;
+
+/**
+ * tau(i, j)^alpha * eta(i, j)^beta for every pair, what ants weigh their
+ * choices by. eta^beta is computed once per solve, the products again after
+ * every pheromone update, so ants only do lookups. Entries follow the layout
+ * of the pheromone matrix, pairs it does not store are computed on demand.
+ * A pair with eta = 0 is never chosen, whatever beta is.
+ */
+class ChoiceInfo
+{
+public:
+    ChoiceInfo(const Problem&, const PheromoneMatrix&, float beta);
+
+    void update(const PheromoneMatrix&, float alpha);
+
+    // true when built for pm with these exponents, otherwise ants fall back
+    // to computing the weights themselves
+    bool matches(const PheromoneMatrix& pm, float alpha, float beta) const {
+        return pheromone_ == &pm && alpha_ == alpha && beta_ == beta;
+    }
+
+    float operator()(int i, int j) const {
+        long long k = pheromone_->index(i, j);
+        return k >= 0 ? choice_[k] : unstored(i, j);
+    }
+
+private:
+    float unstored(int i, int j) const;
+
+    const Problem* problem_;
+    const PheromoneMatrix* pheromone_;
+    float alpha_;
+    float beta_;
+    float defaultChoice_;           // tau^alpha of the pairs without an entry
+    std::vector<float> heuristic_;  // eta^beta
+    std::vector<float> choice_;
+};
+using ChoiceInfoPtr = std::shared_ptr<ChoiceInfo>;
+
 
 class Problem : virtual public common::Problem
 {
 public:
     virtual common::SolutionPtr updateAntPath(common::SolutionPtr ant, PheromoneMatrixPtr pm, float alpha, float beta) = 0;
     virtual void updatePheromoneMatrix(common::SolutionPtr ant, PheromoneMatrixPtr pm, float rho) = 0;
+
+    // eta(i, j), how desirable j is right after i; problems that have one
+    // get choiceInfo filled in by AntColonyOptimization while it solves
+    virtual bool hasHeuristic() const { return false; }
+    virtual float heuristic(int i, int j) const { return 1; }
+
+    // whether going from i to j is worth the same as from j to i, which the
+    // SYMMETRIC pheromone layout relies on
+    virtual bool isSymmetric() const { return false; }
+
+    // adds the pheromone ant leaves on its path, weight times the amount of a
+    // single update, from the ant's cost as the solver evaluated it; problems
+    // that have it get their pheromone updated by AntColonyOptimization
+    // itself, the others through updatePheromoneMatrix
+    virtual bool depositsPheromone() const { return false; }
+    virtual void depositPheromone(common::SolutionPtr ant, PheromoneMatrix& pm, float weight) {}
+
+    // candidate successors of every i as offsets + indexes like in
+    // PheromoneMatrix, for the SPARSE layout; false when there are none
+    virtual bool candidateLists(std::vector<int>& offsets, std::vector<int>& candidates) const { return false; }
+
+    ChoiceInfoPtr choiceInfo;
 };
 using ProblemPtr = std::shared_ptr<Problem>;
 
@@ -58,10 +238,22 @@ public:
     {
         PYBIND11_OVERRIDE_PURE(void, Problem, updatePheromoneMatrix, ant, pm, rho);
     }
+
+    bool isSymmetric() const override
+    {
+        PYBIND11_OVERRIDE(bool, Problem, isSymmetric);
+    }
 };
 using PyProblemPtr = std::shared_ptr<PyProblem>;
 
 
+// how the pheromone is updated after every generation
+enum class PheromoneUpdate
+{
+    BEST,       // evaporation, then deposits by the iteration-best and the global-best ant
+    MAX_MIN     // the same with tau kept within [tauMin, tauMax], reset to tauMax on stagnation
+};
+
 class AntColonyOptimization
 {
 public:
@@ -75,9 +267,34 @@ public:
 
     common::SolutionPtr solve(int generations, int colonySize, float alpha, float beta, float rho);
 
+    // ants of a generation are built on this many threads, 0 for one per
+    // hardware thread; the result does not depend on it
+    void setThreads(int threads);
+
+    // SPARSE needs a problem with candidate lists; throws std::invalid_argument
+    // for SYMMETRIC on a problem that is not symmetric
+    void setPheromoneLayout(PheromoneLayout layout);
+
+    void setPheromoneUpdate(PheromoneUpdate update);
+    // weights of the iteration-best and global-best deposits, 0 leaves one out;
+    // problems without depositPheromone only get the iteration-best ant
+    void setDeposits(float iterationBest, float globalBest);
+    // MAX_MIN: generations without a new global best before tau is reset
+    void setStagnationLimit(int generations);
+
 private:
+    void updatePheromone(common::SolutionPtr iterationBest, common::SolutionPtr globalBest, float rho);
+    // MAX_MIN bounds for the cost of the global best
+    void pheromoneBounds(float bestCost, float& tauMin, float& tauMax) const;
+
     ProblemPtr mProblem;
     PheromoneMatrixPtr mPheromoneMatrix;
+    int mThreads;
+    PheromoneLayout mLayout;
+    PheromoneUpdate mUpdate;
+    float mIterationBestWeight;
+    float mGlobalBestWeight;
+    int mStagnationLimit;
 };
 
 } // namespace ACO
@@ -1,22 +1,29 @@
 #define PYBIND11_DETAILED_ERROR_MESSAGES
 
+#include <cctype>
+#include <cstdint>
 #include <memory>
 
 #include <pybind11/pybind11.h>
+#include <pybind11/functional.h>
 #include <pybind11/stl_bind.h>
 #include <pybind11/stl.h>
 #include <pybind11/cast.h>
 
 #include "common.hpp"
 #include "logger/logger.hpp"
+#include "random/random.hpp"
 
 #include "physics/SA.hpp"
 #include "math/TS.hpp"
 #include "evolutionary/GA.hpp"
+#include "evolutionary/Permutation.hpp"
 #include "swarm/ACO.hpp"
 
 #include "problems/TSP.hpp"
+#include "problems/TSPLIB.hpp"
 #include "problems/JSS.hpp"
+#include "problems/IMRG.hpp"
 
 namespace py = pybind11;
 
@@ -25,6 +32,114 @@ PYBIND11_MAKE_OPAQUE(std::vector<int>);  // without this and the binding, int ve
 PYBIND11_MAKE_OPAQUE(problems::tsp::Cities);
 PYBIND11_MAKE_OPAQUE(problems::jss::TimeMatrix);
 
+// read-only copy of a solution's sequence, TSS.tour or JSSS.schedule; they are
+// changed by assigning a whole sequence, which drops the stored hash
+py::tuple sequenceTuple(const std::vector<int>& values)
+{
+    py::tuple tuple(values.size());
+    for (size_t i = 0; i < values.size(); i++)
+        tuple[i] = values[i];
+    return tuple;
+}
+
+// common::Problem members, on each python Problem base as they are bound
+// without one in common
+template <typename ProblemType, typename... Options>
+void bindProblemMembers(py::class_<ProblemType, Options...>& cls)
+{
+    cls.def("setEvaluationCache", [](ProblemType& p, size_t capacity) {
+            p.setEvaluationCache(capacity);
+        }, py::arg("capacity"))
+        .def("evaluationCacheStats", [](const ProblemType& p) {
+            return p.evaluationCacheStats();
+        })
+        // a callable taking the best cost so far and returning True to stop, or None
+        .def("setStopCondition", [](ProblemType& p, std::function<bool(float)> condition) {
+            p.setStopCondition(condition);
+        }, py::arg("condition"));
+}
+
+// TSP, GA_TSP and ACO_TSP are bound without a common python base,
+// so the members they share through problems::tsp::TSP are added to each
+template <typename TSPType, typename... Options>
+void bindTSPMembers(py::class_<TSPType, Options...>& cls)
+{
+    cls.def(py::init<const problems::tsp::Cities&>(), py::arg("cities"))
+        .def(py::init<const problems::tsp::Instance&>(), py::arg("instance"))
+        .def_static("fromFile", &problems::tsp::loadTSPLIB<TSPType>, py::arg("path"))
+        .def_property("cities", [](const TSPType& p) -> const problems::tsp::Cities& {
+            return p.cities;
+        }, [](TSPType& p, const problems::tsp::Cities& cities) {
+            p.setCities(cities);
+        }, py::return_value_policy::reference_internal)
+        .def_readonly("edgeWeightType", &TSPType::edgeWeightType)
+        .def("distance", [](const TSPType& p, int a, int b) {
+            return p.distance(a, b);
+        }, py::arg("a"), py::arg("b"))
+        .def("buildNeighborLists", [](TSPType& p, int k, int quadrantK) {
+            p.buildNeighborLists(k, quadrantK);
+        }, py::arg("k"), py::arg("quadrantK") = 0)
+        .def("neighbors", [](const TSPType& p, int city) {
+            return p.neighbors.empty() ? std::vector<int>() : p.neighbors.of(city);
+        }, py::arg("city"))
+        .def("setLocalSearch", [](TSPType& p, bool enabled, int k) {
+            p.setLocalSearch(enabled, k);
+        }, py::arg("enabled"), py::arg("k") = 10)
+        .def("constructTour", [](const TSPType& p, problems::tsp::InitialTour type) {
+            return p.constructTour(type);
+        }, py::arg("type"))
+        .def("constructSolution", [](const TSPType& p, problems::tsp::InitialTour type) {
+            return p.constructSolution(type);
+        }, py::arg("type"))
+        .def_property("initialTour", [](const TSPType& p) {
+            return p.initialTour;
+        }, [](TSPType& p, problems::tsp::InitialTour type) {
+            p.setInitialTour(type);
+        })
+        .def_readwrite("seedRatio", &TSPType::seedRatio)
+        .def_property_readonly("evaluations", [](const TSPType& p) {
+            return p.evaluations.load();
+        })
+        .def_property_readonly("moveEvaluations", [](const TSPType& p) {
+            return p.moveEvaluations.load();
+        });
+}
+
+// same for JSSP, GA_JSSP and ACO_JSSP
+template <typename JSSPType, typename... Options>
+void bindJSSPMembers(py::class_<JSSPType, Options...>& cls)
+{
+    cls.def(py::init<const problems::jss::ProcessingTimes&>(), py::arg("products"))
+        .def(py::init<const problems::jss::Instance&>(), py::arg("instance"))
+        .def_static("fromFile", &problems::jss::loadIMRG<JSSPType>, py::arg("path"))
+        .def_property("products", [](const JSSPType& p) -> const problems::jss::ProcessingTimes& {
+            return p.products;
+        }, [](JSSPType& p, const problems::jss::ProcessingTimes& products) {
+            p.setProducts(products);
+        }, py::return_value_policy::reference_internal)
+        .def_readwrite("neighborhood", &JSSPType::neighborhood)
+        .def("bestInsertion", [](JSSPType& p, common::SolutionPtr sol, int position) {
+            float delta;
+            int target = p.bestInsertion(sol, position, delta);
+            return py::make_tuple(target, delta);
+        }, py::arg("solution"), py::arg("position"))
+        .def("insertionLocalSearch", [](JSSPType& p, common::SolutionPtr sol) {
+            return p.insertionLocalSearch(sol);
+        }, py::arg("solution"))
+        .def("setLocalSearch", [](JSSPType& p, bool enabled) {
+            p.setLocalSearch(enabled);
+        }, py::arg("enabled"))
+        .def("constructSchedule", [](const JSSPType& p, problems::jss::InitialSchedule type) {
+            return p.constructSchedule(type);
+        }, py::arg("type"))
+        .def_property("initialSchedule", [](const JSSPType& p) {
+            return p.initialSchedule;
+        }, [](JSSPType& p, problems::jss::InitialSchedule type) {
+            p.setInitialSchedule(type);
+        })
+        .def_readwrite("seedRatio", &JSSPType::seedRatio);
+}
+
 PYBIND11_MODULE(mhac, m)
 {
     // import mhac
@@ -33,6 +148,7 @@ PYBIND11_MODULE(mhac, m)
     py::implicitly_convertible<py::iterable, VectorInt>();
 
     m.def("set_log_level", &setLogLevel, "Setup the log level");
+    m.def("seed", &mhac_random::seed, "Seed the random generator of the calling thread", py::arg("value"));
     
     py::enum_<spdlog::level::level_enum>(m, "LogLevel")
         .value("trace", spdlog::level::trace)
@@ -47,14 +163,38 @@ PYBIND11_MODULE(mhac, m)
     // import mhac.common
     py::module m_common = m.def_submodule("common");
 
-    py::class_<common::Problem, common::PyProblem, common::ProblemPtr>(m_common, "Problem")
-        .def(py::init<>())
+    py::class_<common::Move>(m_common, "Move")
+        .def(py::init<int, int>(), py::arg("i") = 0, py::arg("j") = 0)
+        .def_readwrite("i", &common::Move::i)
+        .def_readwrite("j", &common::Move::j);
+
+    py::class_<mhac_cache::CacheStats>(m_common, "CacheStats")
+        .def_readonly("lookups", &mhac_cache::CacheStats::lookups)
+        .def_readonly("hits", &mhac_cache::CacheStats::hits)
+        .def_readonly("insertions", &mhac_cache::CacheStats::insertions)
+        .def_readonly("evictions", &mhac_cache::CacheStats::evictions)
+        .def_property_readonly("hitRate", &mhac_cache::CacheStats::hitRate);
+
+    py::class_<common::Problem, common::PyProblem, common::ProblemPtr> problem(m_common, "Problem");
+    bindProblemMembers(problem);
+    problem.def(py::init<>())
         .def("generateInitialSolution", &common::Problem::generateInitialSolution)
         .def("generateNewSolution", &common::Problem::generateNewSolution)
-        .def("evaluateSolution", &common::Problem::evaluateSolution);
+        .def("evaluateSolution", &common::Problem::evaluateSolution)
+        .def("improveSolution", &common::Problem::improveSolution)
+        .def("supportsMoves", &common::Problem::supportsMoves)
+        .def("generateMove", &common::Problem::generateMove)
+        .def("evaluateMove", &common::Problem::evaluateMove)
+        .def("applyMove", &common::Problem::applyMove)
+        .def("undoMove", &common::Problem::undoMove)
+        .def("hashAfterMove", &common::Problem::hashAfterMove)
+        .def("moveAttribute", &common::Problem::moveAttribute);
 
     py::class_<common::Solution, common::PySolution, common::SolutionPtr>(m_common, "Solution")
         .def(py::init<>())
+        .def("clone", &common::Solution::clone)
+        // a python hash must fit in 64 bits, e.g. hash(...) & 0xFFFFFFFFFFFFFFFF
+        .def("hash", &common::Solution::hash)
         .def_readwrite("cost", &common::Solution::cost);
     py::bind_vector<common::SolutionVec>(m_common, "SolutionVec");
     py::implicitly_convertible<py::iterable, common::SolutionVec>();
@@ -69,50 +209,112 @@ PYBIND11_MODULE(mhac, m)
     // import mhac.math
     py::module m_math = m.def_submodule("math");
 
+    py::enum_<math::TS::TabuMode>(m_math, "TabuMode")
+        .value("SOLUTION", math::TS::TabuMode::SOLUTION)
+        .value("ATTRIBUTE", math::TS::TabuMode::ATTRIBUTE);
+
+    // solutions with hash 0 are compared with isEqual, the others by hash only
+    py::class_<math::TS::TabuList>(m_math, "TabuList")
+        .def(py::init([](int capacity) {
+            math::TS::TabuList list;
+            list.reset(capacity);
+            return list;
+        }), py::arg("capacity"))
+        .def("reset", &math::TS::TabuList::reset, py::arg("capacity"))
+        .def("contains", &math::TS::TabuList::contains, py::arg("solution"), py::arg("hash"))
+        .def("push", &math::TS::TabuList::push, py::arg("solution"), py::arg("hash"));
+
     py::class_<math::TS::TabuSearch>(m_math, "TabuSearch")
         .def(py::init<common::ProblemPtr>(), py::arg("problem"))
-        .def("solve", &math::TS::TabuSearch::solve, py::arg("iterations"), py::arg("maxTabuListSize"), py::arg("neighborhoodSize"));
+        .def("solve", &math::TS::TabuSearch::solve, py::arg("iterations"), py::arg("maxTabuListSize"), py::arg("neighborhoodSize"))
+        .def("setTabuMode", &math::TS::TabuSearch::setTabuMode, py::arg("mode"));
 
     // import mhac.evolutionary
     py::module m_evolutionary = m.def_submodule("evolutionary");
 
-    py::class_<evolutionary::GA::Problem, evolutionary::GA::PyProblem, evolutionary::GA::ProblemPtr>(m_evolutionary, "Problem")
-        .def(py::init<>())
+    py::class_<evolutionary::GA::Problem, evolutionary::GA::PyProblem, evolutionary::GA::ProblemPtr> gaProblem(m_evolutionary, "Problem");
+    bindProblemMembers(gaProblem);
+    gaProblem.def(py::init<>())
         .def("crossover", &evolutionary::GA::Problem::crossover)
         .def("mutation", &evolutionary::GA::Problem::mutation);
 
     py::enum_<evolutionary::GA::SelectionType>(m_evolutionary, "SelectionType")
         .value("TOURNAMENT", evolutionary::GA::SelectionType::TOURNAMENT)
-        .value("PROPORTIONAL", evolutionary::GA::SelectionType::PROPORTIONAL);
+        .value("PROPORTIONAL", evolutionary::GA::SelectionType::PROPORTIONAL)
+        .value("STOCHASTIC_UNIVERSAL", evolutionary::GA::SelectionType::STOCHASTIC_UNIVERSAL)
+        .value("RANK", evolutionary::GA::SelectionType::RANK);
+
+    py::enum_<evolutionary::GA::CrossoverType>(m_evolutionary, "CrossoverType")
+        .value("ONE_POINT", evolutionary::GA::CrossoverType::ONE_POINT)
+        .value("ORDER", evolutionary::GA::CrossoverType::ORDER)
+        .value("PARTIALLY_MAPPED", evolutionary::GA::CrossoverType::PARTIALLY_MAPPED)
+        .value("CYCLE", evolutionary::GA::CrossoverType::CYCLE)
+        .value("EDGE_ASSEMBLY", evolutionary::GA::CrossoverType::EDGE_ASSEMBLY);
+
+    // the two children of permutations of 0..n-1, cut points drawn from mhac's random
+    m_evolutionary.def("permutationCrossover", [](evolutionary::GA::CrossoverType type, const std::vector<int>& parent1, const std::vector<int>& parent2) {
+            if (parent1.size() != parent2.size())
+                throw std::invalid_argument("the parents must have the same size");
+            std::vector<int> child1, child2;
+            evolutionary::GA::permutationCrossover(type, parent1, parent2, child1, child2);
+            return py::make_tuple(child1, child2);
+        }, py::arg("type"), py::arg("parent1"), py::arg("parent2"));
+
+    py::enum_<evolutionary::GA::MigrationTopology>(m_evolutionary, "MigrationTopology")
+        .value("RING", evolutionary::GA::MigrationTopology::RING)
+        .value("FULLY_CONNECTED", evolutionary::GA::MigrationTopology::FULLY_CONNECTED);
 
     py::class_<evolutionary::GA::GeneticAlgorithm>(m_evolutionary, "GeneticAlgorithm")
         .def(py::init<evolutionary::GA::ProblemPtr>(), py::arg("problem"))
-        .def("solve", &evolutionary::GA::GeneticAlgorithm::solve, py::arg("generations"), py::arg("populationSize"), py::arg("mutationChance"), py::arg("selectionSize"), py::arg("selectionType"));
+        // the GIL is only taken back by calls into problems written in python
+        .def("solve", &evolutionary::GA::GeneticAlgorithm::solve, py::arg("generations"), py::arg("populationSize"), py::arg("mutationChance"), py::arg("selectionSize"), py::arg("selectionType"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("setThreads", &evolutionary::GA::GeneticAlgorithm::setThreads, py::arg("threads"))
+        .def("setIslands", &evolutionary::GA::GeneticAlgorithm::setIslands, py::arg("islands"), py::arg("interval"), py::arg("migrants"),
+             py::arg("topology") = evolutionary::GA::MigrationTopology::RING)
+        .def("setSteadyState", &evolutionary::GA::GeneticAlgorithm::setSteadyState, py::arg("enabled"));
 
     // import mhac.swarm
     py::module m_swarm = m.def_submodule("swarm");
 
+    py::enum_<swarm::ACO::PheromoneLayout>(m_swarm, "PheromoneLayout")
+        .value("DENSE", swarm::ACO::PheromoneLayout::DENSE)
+        .value("SYMMETRIC", swarm::ACO::PheromoneLayout::SYMMETRIC)
+        .value("SPARSE", swarm::ACO::PheromoneLayout::SPARSE);
+
+    py::enum_<swarm::ACO::PheromoneUpdate>(m_swarm, "PheromoneUpdate")
+        .value("BEST", swarm::ACO::PheromoneUpdate::BEST)
+        .value("MAX_MIN", swarm::ACO::PheromoneUpdate::MAX_MIN);
+
     py::class_<swarm::ACO::PheromoneMatrix, swarm::ACO::PheromoneMatrixPtr>(m, "PheromoneMatrix")
-        .def(py::init<int, float>(), py::arg("size"), py::arg("initialValue"))
-        .def("__call__", [](swarm::ACO::PheromoneMatrix &m, int i, int j) -> float & {
-            return m(i, j);  // Direct call to non-const operator()
-        }, py::return_value_policy::reference_internal)
-        .def("__call__", [](const swarm::ACO::PheromoneMatrix &m, int i, int j) -> const float & {
-            return m(i, j);  // Direct call to const operator()
-        }, py::return_value_policy::reference_internal) 
+        .def(py::init<int, float, swarm::ACO::PheromoneLayout>(), py::arg("size"), py::arg("initialValue"), py::arg("layout") = swarm::ACO::PheromoneLayout::DENSE)
+        // by value: pairs a sparse matrix does not store read as its default
+        .def("__call__", [](const swarm::ACO::PheromoneMatrix &m, int i, int j) {
+            return m(i, j);
+        })
         .def("getSize", &swarm::ACO::PheromoneMatrix::getSize)
+        .def("getLayout", &swarm::ACO::PheromoneMatrix::getLayout)
         .def("set", [](swarm::ACO::PheromoneMatrix &m, int i, int j, float value) {
             m(i, j) = value;
         });
 
-    py::class_<swarm::ACO::Problem, swarm::ACO::PyProblem, swarm::ACO::ProblemPtr>(m_swarm, "Problem")
-        .def(py::init<>())
+    py::class_<swarm::ACO::Problem, swarm::ACO::PyProblem, swarm::ACO::ProblemPtr> acoProblem(m_swarm, "Problem");
+    bindProblemMembers(acoProblem);
+    acoProblem.def(py::init<>())
         .def("updateAntPath", &swarm::ACO::Problem::updateAntPath)
-        .def("updatePheromoneMatrix", &swarm::ACO::Problem::updatePheromoneMatrix);
+        .def("updatePheromoneMatrix", &swarm::ACO::Problem::updatePheromoneMatrix)
+        .def("isSymmetric", &swarm::ACO::Problem::isSymmetric);
 
     py::class_<swarm::ACO::AntColonyOptimization>(m_swarm, "AntColonyOptimization")
         .def(py::init<swarm::ACO::ProblemPtr>(), py::arg("problem"))
-        .def("solve", &swarm::ACO::AntColonyOptimization::solve, py::arg("generations"), py::arg("colonySize"), py::arg("alpha"), py::arg("beta"), py::arg("rho"));
+        // the GIL is only taken back by calls into problems written in python
+        .def("solve", &swarm::ACO::AntColonyOptimization::solve, py::arg("generations"), py::arg("colonySize"), py::arg("alpha"), py::arg("beta"), py::arg("rho"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("setThreads", &swarm::ACO::AntColonyOptimization::setThreads, py::arg("threads"))
+        .def("setPheromoneLayout", &swarm::ACO::AntColonyOptimization::setPheromoneLayout, py::arg("layout"))
+        .def("setPheromoneUpdate", &swarm::ACO::AntColonyOptimization::setPheromoneUpdate, py::arg("update"))
+        .def("setDeposits", &swarm::ACO::AntColonyOptimization::setDeposits, py::arg("iterationBest"), py::arg("globalBest"))
+        .def("setStagnationLimit", &swarm::ACO::AntColonyOptimization::setStagnationLimit, py::arg("generations"));
 
     // import mhac.problems
     py::module m_problems = m.def_submodule("problems");
@@ -120,49 +322,187 @@ PYBIND11_MODULE(mhac, m)
     // import mhac.problems.tsp
     py::module m_problems_tsp = m_problems.def_submodule("tsp");
     
+    py::enum_<problems::tsp::EdgeWeightType>(m_problems_tsp, "EdgeWeightType")
+        .value("EUCLIDEAN", problems::tsp::EdgeWeightType::EUCLIDEAN)
+        .value("EUC_2D", problems::tsp::EdgeWeightType::EUC_2D)
+        .value("CEIL_2D", problems::tsp::EdgeWeightType::CEIL_2D)
+        .value("ATT", problems::tsp::EdgeWeightType::ATT)
+        .value("GEO", problems::tsp::EdgeWeightType::GEO)
+        .value("EXPLICIT", problems::tsp::EdgeWeightType::EXPLICIT);
+
     py::class_<problems::tsp::City>(m_problems_tsp, "City")
-        .def(py::init<int, int>())
+        .def(py::init<double, double>())
         .def_readwrite("x", &problems::tsp::City::x)
         .def_readwrite("y", &problems::tsp::City::y)
-        .def("distance", &problems::tsp::City::distance);
+        .def("distance", &problems::tsp::City::distance, py::arg("city"), py::arg("type") = problems::tsp::EdgeWeightType::EUCLIDEAN);
     py::bind_vector<problems::tsp::Cities>(m_problems_tsp, "Cities");
 
+    py::class_<problems::tsp::Instance>(m_problems_tsp, "Instance")
+        .def_readonly("name", &problems::tsp::Instance::name)
+        .def_readonly("edgeWeightType", &problems::tsp::Instance::edgeWeightType)
+        .def_readonly("cities", &problems::tsp::Instance::cities);
+
+    m_problems_tsp.def("read_tsplib", &problems::tsp::readTSPLIB, "Read a TSPLIB .tsp file", py::arg("path"));
+    m_problems_tsp.def("read_tsplib_tour", &problems::tsp::readTSPLIBTour, "Read a TSPLIB .tour file", py::arg("path"));
+
     py::class_<problems::tsp::TSS, common::Solution, problems::tsp::TSSPtr>(m_problems_tsp, "TSS")
         .def(py::init<>())
-        .def_readwrite("tour", &problems::tsp::TSS::tour)
+        .def_property("tour", [](const problems::tsp::TSS& sol) {
+            return sequenceTuple(sol.tour);
+        }, [](problems::tsp::TSS& sol, const std::vector<int>& tour) {
+            sol.tour = tour;
+            sol.storedHash.reset();
+        })
         .def("print", &problems::tsp::TSS::print);
 
-    py::class_<problems::tsp::TSP, common::Problem, problems::tsp::TSPPtr>(m_problems_tsp, "TSP")
-        .def(py::init<const problems::tsp::Cities&>(), py::arg("cities"))
-        .def_readwrite("cities", &problems::tsp::TSP::cities);
-
-    py::class_<problems::tsp::GA_TSP, evolutionary::GA::Problem, problems::tsp::GA_TSPPtr>(m_problems_tsp, "GA_TSP")
-        .def(py::init<const problems::tsp::Cities&>(), py::arg("cities"))
-        .def_readwrite("cities", &problems::tsp::TSP::cities);
-
-    py::class_<problems::tsp::ACO_TSP, swarm::ACO::Problem, problems::tsp::ACO_TSPPtr>(m_problems_tsp, "ACO_TSP")
-        .def(py::init<const problems::tsp::Cities&>(), py::arg("cities"))
-        .def_readwrite("cities", &problems::tsp::TSP::cities);
+    py::class_<problems::tsp::LinkedTSS, common::Solution, problems::tsp::LinkedTSSPtr>(m_problems_tsp, "LinkedTSS")
+        .def(py::init<>())
+        .def_property("tour", &problems::tsp::LinkedTSS::getTour, &problems::tsp::LinkedTSS::setTour)
+        .def("print", &problems::tsp::LinkedTSS::print);
+
+    // the list a LinkedTSS keeps its tour in, bound on its own for checks
+    py::class_<problems::tsp::TwoLevelList>(m_problems_tsp, "TwoLevelList")
+        .def(py::init<const std::vector<int>&>(), py::arg("tour"))
+        .def_property_readonly("tour", [](const problems::tsp::TwoLevelList& list) {
+            std::vector<int> tour;
+            list.get(tour);
+            return sequenceTuple(tour);
+        })
+        .def("__len__", &problems::tsp::TwoLevelList::size)
+        .def("next", &problems::tsp::TwoLevelList::next, py::arg("city"))
+        .def("prev", &problems::tsp::TwoLevelList::prev, py::arg("city"))
+        .def("between", &problems::tsp::TwoLevelList::between, py::arg("a"), py::arg("b"), py::arg("c"))
+        .def("reverse", &problems::tsp::TwoLevelList::reverse, py::arg("first"), py::arg("last"));
+
+    py::enum_<problems::tsp::InitialTour>(m_problems_tsp, "InitialTour")
+        .value("RANDOM", problems::tsp::InitialTour::RANDOM)
+        .value("NEAREST_NEIGHBOR", problems::tsp::InitialTour::NEAREST_NEIGHBOR)
+        .value("GREEDY", problems::tsp::InitialTour::GREEDY)
+        .value("SPACE_FILLING_CURVE", problems::tsp::InitialTour::SPACE_FILLING_CURVE);
+
+    py::enum_<problems::tsp::TourType>(m_problems_tsp, "TourType")
+        .value("ARRAY", problems::tsp::TourType::ARRAY)
+        .value("TWO_LEVEL_LIST", problems::tsp::TourType::TWO_LEVEL_LIST);
+
+    py::class_<problems::tsp::LocalSearch, problems::tsp::LocalSearchPtr>(m_problems_tsp, "LocalSearch")
+        .def(py::init<const problems::tsp::TSP&, int>(), py::arg("problem"), py::arg("k") = 10, py::keep_alive<1, 2>())
+        .def(py::init<const problems::tsp::GA_TSP&, int>(), py::arg("problem"), py::arg("k") = 10, py::keep_alive<1, 2>())
+        .def(py::init<const problems::tsp::ACO_TSP&, int>(), py::arg("problem"), py::arg("k") = 10, py::keep_alive<1, 2>())
+        // the tour is improved in place, the solution cost is left as it was
+        .def("improve", [](const problems::tsp::LocalSearch& ls, problems::tsp::TSS& sol) {
+            sol.storedHash.reset();
+            return ls.improve(sol.tour);
+        }, py::arg("solution"))
+        .def("improve", [](const problems::tsp::LocalSearch& ls, problems::tsp::LinkedTSS& sol) {
+            sol.storedHash.reset();
+            return ls.improve(sol.tour);
+        }, py::arg("solution"));
+
+    py::class_<problems::tsp::EdgeAssembly, problems::tsp::EdgeAssemblyPtr>(m_problems_tsp, "EdgeAssembly")
+        .def(py::init<const problems::tsp::TSP&, int, int>(), py::arg("problem"), py::arg("trials") = 30, py::arg("k") = 10, py::keep_alive<1, 2>())
+        .def(py::init<const problems::tsp::GA_TSP&, int, int>(), py::arg("problem"), py::arg("trials") = 30, py::arg("k") = 10, py::keep_alive<1, 2>())
+        .def(py::init<const problems::tsp::ACO_TSP&, int, int>(), py::arg("problem"), py::arg("trials") = 30, py::arg("k") = 10, py::keep_alive<1, 2>())
+        // the child's tour and its length minus parent1's
+        .def("cross", [](const problems::tsp::EdgeAssembly& eax, const std::vector<int>& parent1, const std::vector<int>& parent2) {
+            std::vector<int> child;
+            double delta = eax.cross(parent1, parent2, child);
+            return py::make_tuple(child, delta);
+        }, py::arg("parent1"), py::arg("parent2"))
+        .def_property_readonly("trials", &problems::tsp::EdgeAssembly::getTrials);
+
+    py::class_<problems::tsp::TSP, common::Problem, problems::tsp::TSPPtr> tsp(m_problems_tsp, "TSP");
+    bindTSPMembers(tsp);
+    tsp.def_readwrite("tourType", &problems::tsp::TSP::tourType);
+
+    py::class_<problems::tsp::GA_TSP, evolutionary::GA::Problem, problems::tsp::GA_TSPPtr> ga_tsp(m_problems_tsp, "GA_TSP");
+    bindTSPMembers(ga_tsp);
+    ga_tsp.def_readwrite("crossoverType", &problems::tsp::GA_TSP::crossoverType)
+        .def("setEdgeAssembly", &problems::tsp::GA_TSP::setEdgeAssembly, py::arg("enabled"), py::arg("trials") = 30, py::arg("k") = 10);
+
+    py::class_<problems::tsp::ACO_TSP, swarm::ACO::Problem, problems::tsp::ACO_TSPPtr> aco_tsp(m_problems_tsp, "ACO_TSP");
+    bindTSPMembers(aco_tsp);
 
     // import mhac.problems.jss
     py::module m_problems_jss = m_problems.def_submodule("jss");
 
     py::bind_vector<problems::jss::TimeMatrix>(m_problems_jss, "TimeMatrix");
 
+    // also readable as a products x machines int32 buffer, np.asarray(p.products)
+    // needs no copy, and any 2d integer array converts to it
+    py::class_<problems::jss::ProcessingTimes>(m_problems_jss, "ProcessingTimes", py::buffer_protocol())
+        .def(py::init<const problems::jss::TimeMatrix&>(), py::arg("matrix"))
+        .def(py::init([](py::buffer b) {
+            py::buffer_info info = b.request();
+            char kind = info.format.empty() ? 0 : info.format.back();
+            if (info.ndim != 2 || std::string("bBhHiIlLqQ").find(kind) == std::string::npos)
+                throw std::invalid_argument("expected a 2d integer array of products x machines");
+
+            // any integer width and any strides, e.g. numpy's default int64 or a transposed view
+            bool isSigned = std::islower(kind);
+            auto read = [&info, isSigned](const char* p) -> long long {
+                switch (info.itemsize)
+                {
+                    case 1: return isSigned ? *(const int8_t*) p : *(const uint8_t*) p;
+                    case 2: return isSigned ? *(const int16_t*) p : *(const uint16_t*) p;
+                    case 4: return isSigned ? *(const int32_t*) p : *(const uint32_t*) p;
+                    default: return isSigned ? *(const int64_t*) p : (long long) *(const uint64_t*) p;
+                }
+            };
+
+            int products = info.shape[0];
+            int machines = info.shape[1];
+            std::vector<int> times((size_t) products * machines);
+            for (int i = 0; i < products; i++)
+                for (int j = 0; j < machines; j++)
+                    times[(size_t) i * machines + j] = read((const char*) info.ptr + i * info.strides[0] + j * info.strides[1]);
+            return problems::jss::ProcessingTimes(products, machines, times);
+        }), py::arg("array"))
+        .def_buffer([](const problems::jss::ProcessingTimes& t) {
+            return py::buffer_info(const_cast<int*>(t.data().data()), sizeof(int), py::format_descriptor<int>::format(), 2,
+                                   {(py::ssize_t) t.size(), (py::ssize_t) t.machines()},
+                                   {(py::ssize_t) (sizeof(int) * t.machines()), (py::ssize_t) sizeof(int)}, true);
+        })
+        .def("__call__", &problems::jss::ProcessingTimes::operator(), py::arg("product"), py::arg("machine"))
+        .def("__len__", &problems::jss::ProcessingTimes::size)
+        .def_property_readonly("machines", &problems::jss::ProcessingTimes::machines)
+        .def("toMatrix", &problems::jss::ProcessingTimes::toMatrix);
+    py::implicitly_convertible<problems::jss::TimeMatrix, problems::jss::ProcessingTimes>();
+    py::implicitly_convertible<py::buffer, problems::jss::ProcessingTimes>();
+
+    py::class_<problems::jss::Instance>(m_problems_jss, "Instance")
+        .def_readonly("name", &problems::jss::Instance::name)
+        .def_readonly("products", &problems::jss::Instance::products)
+        .def_readonly("dueDates", &problems::jss::Instance::dueDates);
+
+    m_problems_jss.def("read_imrg", &problems::jss::readIMRG, "Read an imrg instance file", py::arg("path"));
+    m_problems_jss.def("read_imrg_directory", &problems::jss::readIMRGDirectory, "Read every .txt instance of a directory", py::arg("directory"));
+    m_problems_jss.def("read_imrg_best", &problems::jss::readIMRGBest, "Read a best values CSV file", py::arg("path"));
+
     py::class_<problems::jss::JSSS, common::Solution, problems::jss::JSSSPtr>(m_problems_jss, "JSSS")
         .def(py::init<>())
-        .def_readwrite("schedule", &problems::jss::JSSS::schedule)
+        .def_property("schedule", [](const problems::jss::JSSS& sol) {
+            return sequenceTuple(sol.schedule);
+        }, [](problems::jss::JSSS& sol, const std::vector<int>& schedule) {
+            sol.schedule = schedule;
+            sol.storedHash.reset();
+        })
         .def("print", &problems::jss::JSSS::print);
 
-    py::class_<problems::jss::JSSP, common::Problem, problems::jss::JSSPPtr>(m_problems_jss, "JSSP")
-        .def(py::init<const problems::jss::TimeMatrix&>())
-        .def_readwrite("products", &problems::jss::JSSP::products);
+    py::enum_<problems::jss::Neighborhood>(m_problems_jss, "Neighborhood")
+        .value("SWAP", problems::jss::Neighborhood::SWAP)
+        .value("INSERTION", problems::jss::Neighborhood::INSERTION);
+
+    py::enum_<problems::jss::InitialSchedule>(m_problems_jss, "InitialSchedule")
+        .value("RANDOM", problems::jss::InitialSchedule::RANDOM)
+        .value("NEH", problems::jss::InitialSchedule::NEH);
+
+    py::class_<problems::jss::JSSP, common::Problem, problems::jss::JSSPPtr> jssp(m_problems_jss, "JSSP");
+    bindJSSPMembers(jssp);
 
-    py::class_<problems::jss::GA_JSSP, evolutionary::GA::Problem, problems::jss::GA_JSSPPtr>(m_problems_jss, "GA_JSSP")
-        .def(py::init<const problems::jss::TimeMatrix&>())
-        .def_readwrite("products", &problems::jss::JSSP::products);
+    py::class_<problems::jss::GA_JSSP, evolutionary::GA::Problem, problems::jss::GA_JSSPPtr> ga_jssp(m_problems_jss, "GA_JSSP");
+    bindJSSPMembers(ga_jssp);
+    ga_jssp.def_readwrite("crossoverType", &problems::jss::GA_JSSP::crossoverType);
 
-    py::class_<problems::jss::ACO_JSSP, swarm::ACO::Problem, problems::jss::ACO_JSSPPtr>(m_problems_jss, "ACO_JSSP")
-        .def(py::init<const problems::jss::TimeMatrix&>())
-        .def_readwrite("products", &problems::jss::JSSP::products);
+    py::class_<problems::jss::ACO_JSSP, swarm::ACO::Problem, problems::jss::ACO_JSSPPtr> aco_jssp(m_problems_jss, "ACO_JSSP");
+    bindJSSPMembers(aco_jssp);
 }
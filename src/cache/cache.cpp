@@ -0,0 +1,83 @@
+#include "logger/logger.hpp"
+
+#include "cache/cache.hpp"
+
+namespace mhac_cache
+{
+
+EvaluationCache::EvaluationCache(size_t capacity)
+{
+    size_t size = 1;
+    while (size < capacity)
+        size *= 2;
+    mEntries.resize(size);
+}
+
+bool EvaluationCache::find(std::uint64_t key, float& cost)
+{
+    if (key == 0)
+    {
+        // e.g. python solutions not overriding hash(), said once per cache
+        if (!mWarnedUnhashed.exchange(true))
+            globalLogger->warn("Solutions without a hash (hash() returns 0) are evaluated without the cache");
+        return false;
+    }
+
+    mLookups.fetch_add(1, std::memory_order_relaxed);
+
+    // the hashes are well mixed, their low bits pick the slot
+    size_t slot = key & (mEntries.size() - 1);
+    std::lock_guard<std::mutex> guard(lock(slot));
+    if (mEntries[slot].key != key)
+        return false;
+
+    cost = mEntries[slot].cost;
+    mHits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void EvaluationCache::insert(std::uint64_t key, float cost)
+{
+    if (key == 0)
+        return;
+
+    size_t slot = key & (mEntries.size() - 1);
+    std::lock_guard<std::mutex> guard(lock(slot));
+    Entry& entry = mEntries[slot];
+    if (entry.key == key)
+        return;
+
+    if (entry.key != 0)
+        mEvictions.fetch_add(1, std::memory_order_relaxed);
+    mInsertions.fetch_add(1, std::memory_order_relaxed);
+
+    entry.key = key;
+    entry.cost = cost;
+}
+
+void EvaluationCache::clear()
+{
+    for (size_t slot = 0; slot < mEntries.size(); slot++)
+    {
+        std::lock_guard<std::mutex> guard(lock(slot));
+        mEntries[slot] = Entry();
+    }
+
+    mLookups = 0;
+    mHits = 0;
+    mInsertions = 0;
+    mEvictions = 0;
+    mWarnedUnhashed = false;
+}
+
+CacheStats EvaluationCache::stats() const
+{
+    CacheStats stats;
+    stats.lookups = mLookups.load();
+    stats.hits = mHits.load();
+    stats.insertions = mInsertions.load();
+    stats.evictions = mEvictions.load();
+    return stats;
+}
+
+} // namespace mhac_cache
@@ -1,10 +1,13 @@
 #include <limits>
 #include <algorithm>
 #include <memory>
+#include <numeric>
+#include <stdexcept>
 
 #include "common.hpp"
 #include "logger/logger.hpp"
 #include "random/random.hpp"
+#include "parallel/parallel.hpp"
 
 #include "evolutionary/GA.hpp"
 
@@ -14,93 +17,344 @@ namespace GA
 {
 
 GeneticAlgorithm::GeneticAlgorithm(ProblemPtr probType)
-    :mProblem(probType), mSelectionSize(0)
+    :mProblem(probType), mThreads(1), mIslands(1), mMigrationInterval(10), mMigrants(1),
+     mTopology(MigrationTopology::RING), mSteadyState(false)
 {
     globalLogger->flush_on(spdlog::level::err);
     globalLogger->debug("Initializing GeneticAlgorithm");
 }
 
-common::SolutionPtr GeneticAlgorithm::tournamentSelection()
+float GeneticAlgorithm::evaluate(const int* genome)
 {
-    std::vector<int> indexes = mhac_random::sample(mPopulation.size(), mSelectionSize);
+    // the same cache and keys as evaluate() on the solution of the genome
+    mhac_cache::EvaluationCache* cache = mProblem->evaluationCache.get();
+    if (!cache)
+        return mProblem->evaluateGenome(genome);
 
-    int minElement = std::numeric_limits<int>::max();
-    int indexOfMin = -1;
+    std::uint64_t key = mProblem->hashGenome(genome);
+    float cost;
+    if (cache->find(key, cost))
+        return cost;
 
-    for (const int index: indexes)
+    cost = mProblem->evaluateGenome(genome);
+    cache->insert(key, cost);
+    return cost;
+}
+
+void GeneticAlgorithm::initialize(Population& population, int k)
+{
+    if (population.hasGenomes())
+    {
+        int* genome = population.childGenome(k);
+        mProblem->initialGenome(genome);
+        mProblem->improveGenome(genome);
+        population.childCost(k) = evaluate(genome);
+        return;
+    }
+
+    auto sol = mProblem->generateInitialSolution();
+    sol->cost = mProblem->evaluate(sol);
+    mProblem->improveSolution(sol);
+    population.childSolution(k) = sol;
+    population.childCost(k) = sol->cost;
+}
+
+void GeneticAlgorithm::breed(Population& population, const Selector& selector, int pair, int first, float mutationChance)
+{
+    // selection
+    int parent1 = selector.select(2 * pair);
+    int parent2 = selector.select(2 * pair + 1);
+
+    // the second child of an odd last pair is dropped
+    bool second = first + 1 < population.size();
+
+    if (population.hasGenomes())
     {
-        if (mPopulation[index]->cost < minElement)
+        // the dropped child still needs somewhere to be written
+        thread_local std::vector<int> spare;
+        if ((int) spare.size() < population.genomeSize())
+            spare.resize(population.genomeSize());
+
+        int* child1 = population.childGenome(first);
+        int* child2 = second ? population.childGenome(first + 1) : spare.data();
+
+        // crossover, mutation and local search change the children in place,
+        // they are only evaluated once at the end
+        mProblem->crossoverGenomes(population.genome(parent1), population.genome(parent2), child1, child2);
+
+        mProblem->mutateGenome(child1, mutationChance);
+        mProblem->improveGenome(child1);
+        population.childCost(first) = evaluate(child1);
+
+        if (second)
         {
-            minElement = mPopulation[index]->cost;
-            indexOfMin = index;
+            mProblem->mutateGenome(child2, mutationChance);
+            mProblem->improveGenome(child2);
+            population.childCost(first + 1) = evaluate(child2);
         }
-    }    
-    return mPopulation[indexOfMin];
+        return;
+    }
+
+    // crossover
+    common::SolutionVec res = mProblem->crossover(population.solution(parent1), population.solution(parent2));
+    common::SolutionPtr child1 = res[0];
+    common::SolutionPtr child2 = res[1];
+
+    // mutation
+    child1 = mProblem->mutation(child1, mutationChance);
+    child2 = mProblem->mutation(child2, mutationChance);
+
+    // local search (memetic step), a no-op unless the problem provides one
+    mProblem->improveSolution(child1);
+    mProblem->improveSolution(child2);
+
+    // create new generation
+    population.childSolution(first) = child1;
+    population.childCost(first) = child1->cost;
+
+    if (second)
+    {
+        population.childSolution(first + 1) = child2;
+        population.childCost(first + 1) = child2->cost;
+    }
 }
 
-common::SolutionPtr GeneticAlgorithm::proportionalSelection()
+void GeneticAlgorithm::steadyStateGeneration(Population& population, const Selector& selector, std::vector<int>& worst, int pairs,
+                                             unsigned long long seed, unsigned long long firstStream, float mutationChance)
 {
-    return nullptr;
+    auto byCost = [&population](int a, int b) {
+        return population.cost(a) < population.cost(b);
+    };
+
+    worst.resize(population.size());
+    std::iota(worst.begin(), worst.end(), 0);
+    std::make_heap(worst.begin(), worst.end(), byCost);
+
+    // children 0 and 1 are the buffer of every step
+    int children = std::min(population.size(), 2);
+
+    for (int step = 0; step < pairs; step++)
+    {
+        mhac_random::seedStream(seed, firstStream + step);
+        breed(population, selector, step, 0, mutationChance);
+
+        for (int child = 0; child < children; child++)
+        {
+            if (population.childCost(child) >= population.cost(worst.front()))
+                continue;
+
+            std::pop_heap(worst.begin(), worst.end(), byCost);
+            population.replace(worst.back(), child);
+            std::push_heap(worst.begin(), worst.end(), byCost);
+        }
+    }
 }
 
 common::SolutionPtr GeneticAlgorithm::solve(int generations, int populationSize, float mutationChance, int selectionSize, SelectionType selectionType)
 {
-    mSelectionSize = selectionSize;
+    if (selectionType < SelectionType::TOURNAMENT || selectionType >= SelectionType::NUM_SELECTIONS)
+        throw std::invalid_argument("unknown selection type");
+    if (selectionSize < 1)
+        throw std::invalid_argument("the selection size must be at least 1");
+    if (mSteadyState && selectionType != SelectionType::TOURNAMENT)
+        throw std::invalid_argument("steady state needs tournament selection");
 
-    // initialization
-    for (int i = 0; i < populationSize; i++)
-    {
-        auto sol = mProblem->generateInitialSolution();
-        sol->cost = mProblem->evaluateSolution(sol);
-        mPopulation.push_back(sol);
-    }
+    // the populations of the previous solve are dropped, their memory is reused
+    int genomeSize = mProblem->genomeSize();
+    mPopulations.resize(mIslands);
+    for (Population& population: mPopulations)
+        population.reset(populationSize, genomeSize);
+    mSelectors.resize(mIslands);
+    mWorst.resize(mIslands);
+
+    mhac_parallel::ThreadPool pool(mhac_parallel::threadCount(mThreads));
+
+    // every individual and every pair of children draws from its own random
+    // stream, so the populations are the same on any number of threads; a
+    // single island draws the same streams as the plain GA
+    unsigned long long seed = mhac_random::randint(0, std::numeric_limits<int>::max());
+    unsigned long long pairs = (populationSize + 1) / 2;
+    unsigned long long firstPairStream = (unsigned long long) mIslands * populationSize;
 
-    for (int gen = 0; gen < generations; gen++)
+    // the selection of a generation, SUS draws from a stream of its own
+    auto prepare = [&](int island, int gen) {
+        mhac_random::seedStream(seed + 1, (unsigned long long) gen * mIslands + island);
+        const Population& population = mPopulations[island];
+        mSelectors[island].build(selectionType, population.costs(), populationSize, selectionSize, 2 * pairs);
+    };
+
+    // steps of a steady state generation take the streams of its pairs
+    auto steadyState = [&](int island, int gen) {
+        prepare(island, gen);
+        steadyStateGeneration(mPopulations[island], mSelectors[island], mWorst[island], pairs,
+                              seed, firstPairStream + ((unsigned long long) gen * mIslands + island) * pairs, mutationChance);
+    };
+
+    if (mIslands == 1)
     {
-        common::SolutionVec children;
+        Population& population = mPopulations[0];
+
+        // initialization
+        pool.run(populationSize, [&](int k) {
+            mhac_random::seedStream(seed, k);
+            initialize(population, k);
+        });
+        population.swap();
 
-        while ((int) children.size() < populationSize)
+        for (int gen = 0; gen < generations; gen++)
         {
-            common::SolutionPtr parent1, parent2;
-
-            // selection
-            switch (selectionType)
-            {
-                case SelectionType::TOURNAMENT:
-                {
-                    parent1 = tournamentSelection();
-                    parent2 = tournamentSelection();
-                    break;
-                }
+            if (mSteadyState) {
+                steadyState(0, gen);
+            }
+            else {
+                prepare(0, gen);
+                pool.run((int) pairs, [&](int pair) {
+                    mhac_random::seedStream(seed, firstPairStream + gen * pairs + pair);
+                    breed(population, mSelectors[0], pair, 2 * pair, mutationChance);
+                });
 
-                default:
-                    break;
+                // the old population becomes the buffer of the next generation
+                population.swap();
             }
 
-            // crossover
-            common::SolutionPtr child1, child2;
-            common::SolutionVec res = mProblem->crossover(parent1, parent2);
-            child1 = res[0];
-            child2 = res[1];
+            if (mProblem->shouldStop(population.cost(population.best())))
+                break;
+        }
+    }
+    else
+    {
+        // the islands only meet to migrate, an island evolves on a single
+        // thread between two migrations
+        for (int gen = 0; gen < generations || gen == 0; gen += mMigrationInterval)
+        {
+            int epochEnd = std::min(gen + mMigrationInterval, generations);
+
+            pool.run(mIslands, [&](int island) {
+                Population& population = mPopulations[island];
 
-            // mutation
-            child1 = mProblem->mutation(child1, mutationChance);
-            child2 = mProblem->mutation(child2, mutationChance);
+                if (gen == 0) {
+                    for (int k = 0; k < populationSize; k++) {
+                        mhac_random::seedStream(seed, (unsigned long long) island * populationSize + k);
+                        initialize(population, k);
+                    }
+                    population.swap();
+                }
 
-            // create new generation
-            children.push_back(child1);
+                for (int g = gen; g < epochEnd; g++) {
+                    if (mSteadyState) {
+                        steadyState(island, g);
+                        continue;
+                    }
 
-            if ((int) children.size() < populationSize)
-                children.push_back(child2);
+                    prepare(island, g);
+                    for (int pair = 0; pair < (int) pairs; pair++) {
+                        mhac_random::seedStream(seed, firstPairStream + ((unsigned long long) g * mIslands + island) * pairs + pair);
+                        breed(population, mSelectors[island], pair, 2 * pair, mutationChance);
+                    }
+                    population.swap();
+                }
+            });
+
+            // the islands are only polled between epochs
+            const Population& best = mPopulations[bestIsland()];
+            if (mProblem->shouldStop(best.cost(best.best())))
+                break;
+
+            if (epochEnd < generations)
+                migrate();
         }
+    }
+
+    // return the best from all the islands
+    const Population& population = mPopulations[bestIsland()];
+    int best = population.best();
+    if (!population.hasGenomes())
+        return population.solution(best);
 
-        mPopulation = children;
+    common::SolutionPtr sol = mProblem->genomeSolution(population.genome(best));
+    sol->cost = population.cost(best);
+    return sol;
+}
+
+int GeneticAlgorithm::bestIsland() const
+{
+    int bestIsland = 0;
+    for (int island = 1; island < (int) mPopulations.size(); island++)
+    {
+        if (mPopulations[island].cost(mPopulations[island].best()) < mPopulations[bestIsland].cost(mPopulations[bestIsland].best()))
+            bestIsland = island;
+    }
+    return bestIsland;
+}
+
+void GeneticAlgorithm::migrate()
+{
+    int islands = mPopulations.size();
+    int size = mPopulations[0].size();
+    int migrants = std::min(mMigrants, size);
+
+    std::vector<std::vector<int>> order(islands, std::vector<int>(size));
+    for (int i = 0; i < islands; i++)
+    {
+        const float* costs = mPopulations[i].costs();
+        std::iota(order[i].begin(), order[i].end(), 0);
+        std::stable_sort(order[i].begin(), order[i].end(), [costs](int a, int b) {
+            return costs[a] < costs[b];
+        });
     }
 
-    // return the best from the population
-    return *std::min_element(mPopulation.begin(), mPopulation.end(), [](const common::SolutionPtr& a, const common::SolutionPtr& b) {
-        return a->cost < b->cost;
-    });
+    // the emigrants are all copied out before any island takes its immigrants in
+    mEmigrants.reset(islands * migrants, mPopulations[0].genomeSize());
+    for (int i = 0; i < islands; i++)
+    {
+        for (int k = 0; k < migrants; k++)
+            mEmigrants.copy(i * migrants + k, mPopulations[i], order[i][k]);
+    }
+
+    for (int i = 0; i < islands; i++)
+    {
+        std::vector<int> immigrants;
+        for (int j = 0; j < islands; j++)
+        {
+            bool linked = mTopology == MigrationTopology::FULLY_CONNECTED ? j != i : (j + 1) % islands == i;
+            for (int k = 0; linked && k < migrants; k++)
+                immigrants.push_back(j * migrants + k);
+        }
+        std::stable_sort(immigrants.begin(), immigrants.end(), [this](int a, int b) {
+            return mEmigrants.cost(a) < mEmigrants.cost(b);
+        });
+
+        // the best immigrants against the worst residents, while they win
+        Population& population = mPopulations[i];
+        for (int k = 0; k < (int) immigrants.size() && k < size; k++)
+        {
+            int worst = order[i][size - 1 - k];
+            if (mEmigrants.cost(immigrants[k]) >= population.cost(worst))
+                break;
+            population.copy(worst, mEmigrants, immigrants[k]);
+        }
+    }
+}
+
+void GeneticAlgorithm::setSteadyState(bool enabled)
+{
+    mSteadyState = enabled;
+}
+
+void GeneticAlgorithm::setThreads(int threads)
+{
+    mThreads = threads;
+}
+
+void GeneticAlgorithm::setIslands(int islands, int interval, int migrants, MigrationTopology topology)
+{
+    if (islands < 1 || interval < 1 || migrants < 0)
+        throw std::invalid_argument("setIslands needs at least 1 island, an interval of at least 1 generation and no negative migrants");
+
+    mIslands = islands;
+    mMigrationInterval = interval;
+    mMigrants = migrants;
+    mTopology = topology;
 }
 
 } // namespace GA
@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "random/random.hpp"
+
+#include "evolutionary/Marks.hpp"
+#include "evolutionary/Permutation.hpp"
+
+namespace evolutionary
+{
+namespace GA
+{
+
+namespace
+{
+
+struct Scratch
+{
+    Marks marks;
+    std::vector<int> position;  // index of every gene in a parent
+    std::vector<int> slots;     // positions of repeated genes
+};
+
+Scratch& scratch()
+{
+    thread_local Scratch s;
+    return s;
+}
+
+void indexGenes(const int* parent, int n, std::vector<int>& position)
+{
+    if ((int) position.size() < n)
+        position.resize(n);
+
+    for (int i = 0; i < n; i++)
+        position[parent[i]] = i;
+}
+
+void orderChild(const int* donor, const int* other, int* child, int n, int first, int last)
+{
+    Marks& marks = scratch().marks;
+    marks.reset(n);
+
+    for (int i = first; i < last; i++)
+    {
+        child[i] = donor[i];
+        marks.add(donor[i]);
+    }
+
+    int to = last == n ? 0 : last;
+    for (int k = 0; k < n; k++)
+    {
+        int gene = other[(last + k) % n];
+        if (marks.has(gene))
+            continue;
+
+        child[to] = gene;
+        to = to + 1 == n ? 0 : to + 1;
+    }
+}
+
+void partiallyMappedChild(const int* donor, const int* other, int* child, int n, int first, int last)
+{
+    Scratch& s = scratch();
+    s.marks.reset(n);
+    indexGenes(donor, n, s.position);
+
+    for (int i = first; i < last; i++)
+    {
+        child[i] = donor[i];
+        s.marks.add(donor[i]);
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        if (i >= first && i < last)
+            continue;
+
+        // a gene of the segment stands for the one other has at its place
+        int gene = other[i];
+        while (s.marks.has(gene))
+            gene = other[s.position[gene]];
+        child[i] = gene;
+    }
+}
+
+} // namespace
+
+void permutationCrossover(CrossoverType type, const int* parent1, const int* parent2, int* child1, int* child2, int n)
+{
+    if (type == CrossoverType::EDGE_ASSEMBLY)
+        throw std::invalid_argument("the edge assembly crossover is only available for GA_TSP");
+
+    if (n == 0)
+        return;
+
+    if (type == CrossoverType::ONE_POINT)
+    {
+        onePointCrossover(parent1, parent2, child1, child2, n, mhac_random::random(0, n - 1));
+        return;
+    }
+
+    if (type == CrossoverType::CYCLE)
+    {
+        cycleCrossover(parent1, parent2, child1, child2, n);
+        return;
+    }
+
+    int first = mhac_random::randint(0, n);
+    int last = mhac_random::randint(0, n);
+    if (first > last)
+        std::swap(first, last);
+
+    if (type == CrossoverType::ORDER)
+        orderCrossover(parent1, parent2, child1, child2, n, first, last);
+    else
+        partiallyMappedCrossover(parent1, parent2, child1, child2, n, first, last);
+}
+
+void permutationCrossover(CrossoverType type, const std::vector<int>& parent1, const std::vector<int>& parent2,
+                          std::vector<int>& child1, std::vector<int>& child2)
+{
+    child1.resize(parent1.size());
+    child2.resize(parent1.size());
+    permutationCrossover(type, parent1.data(), parent2.data(), child1.data(), child2.data(), parent1.size());
+}
+
+void onePointCrossover(const int* parent1, const int* parent2, int* child1, int* child2, int n, int cut)
+{
+    std::copy(parent1, parent1 + cut, child1);
+    std::copy(parent2, parent2 + cut, child2);
+
+    std::copy(parent2 + cut, parent2 + n, child1 + cut);
+    std::copy(parent1 + cut, parent1 + n, child2 + cut);
+
+    repairPermutation(child1, n);
+    repairPermutation(child2, n);
+}
+
+void orderCrossover(const int* parent1, const int* parent2, int* child1, int* child2, int n, int first, int last)
+{
+    orderChild(parent1, parent2, child1, n, first, last);
+    orderChild(parent2, parent1, child2, n, first, last);
+}
+
+void partiallyMappedCrossover(const int* parent1, const int* parent2, int* child1, int* child2, int n, int first, int last)
+{
+    partiallyMappedChild(parent1, parent2, child1, n, first, last);
+    partiallyMappedChild(parent2, parent1, child2, n, first, last);
+}
+
+void cycleCrossover(const int* parent1, const int* parent2, int* child1, int* child2, int n)
+{
+    Scratch& s = scratch();
+    s.marks.reset(n);
+    indexGenes(parent1, n, s.position);
+
+    // the marks hold the positions already assigned here
+    bool swapped = false;
+    for (int start = 0; start < n; start++)
+    {
+        if (s.marks.has(start))
+            continue;
+
+        int i = start;
+        do
+        {
+            child1[i] = swapped ? parent2[i] : parent1[i];
+            child2[i] = swapped ? parent1[i] : parent2[i];
+            s.marks.add(i);
+            i = s.position[parent2[i]];
+        } while (i != start);
+
+        swapped = !swapped;
+    }
+}
+
+void repairPermutation(int* genes, int n)
+{
+    Scratch& s = scratch();
+    s.marks.reset(n);
+    s.slots.clear();
+
+    for (int i = 0; i < n; i++)
+    {
+        if (s.marks.has(genes[i]))
+            s.slots.push_back(i);
+        else
+            s.marks.add(genes[i]);
+    }
+
+    size_t slot = 0;
+    for (int gene = 0; gene < n && slot < s.slots.size(); gene++)
+    {
+        if (!s.marks.has(gene))
+            genes[s.slots[slot++]] = gene;
+    }
+}
+
+void repairPermutation(std::vector<int>& genes)
+{
+    repairPermutation(genes.data(), genes.size());
+}
+
+} // namespace GA
+} // namespace evolutionary
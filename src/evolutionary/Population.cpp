@@ -0,0 +1,51 @@
+#include <algorithm>
+
+#include "evolutionary/Population.hpp"
+
+namespace evolutionary
+{
+namespace GA
+{
+
+void Population::reset(int size, int genomeSize)
+{
+    mSize = size;
+    mGenomeSize = genomeSize;
+    mCurrent = 0;
+
+    for (int g = 0; g < 2; g++)
+    {
+        mGenomes[g].assign((size_t) size * genomeSize, 0);
+        mCosts[g].assign(size, 0);
+        mSolutions[g].assign(genomeSize > 0 ? 0 : size, nullptr);
+    }
+}
+
+int Population::best() const
+{
+    return std::min_element(mCosts[mCurrent].begin(), mCosts[mCurrent].end()) - mCosts[mCurrent].begin();
+}
+
+void Population::copy(int k, const Population& from, int j)
+{
+    if (hasGenomes())
+        std::copy(from.genome(j), from.genome(j) + mGenomeSize, genome(k));
+    else
+        solution(k) = from.solution(j);
+
+    mCosts[mCurrent][k] = from.cost(j);
+}
+
+void Population::replace(int k, int j)
+{
+    int child = mCurrent ^ 1;
+    if (hasGenomes())
+        std::copy(childGenome(j), childGenome(j) + mGenomeSize, genome(k));
+    else
+        solution(k) = mSolutions[child][j];
+
+    mCosts[mCurrent][k] = mCosts[child][j];
+}
+
+} // namespace GA
+} // namespace evolutionary
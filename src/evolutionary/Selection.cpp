@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "random/random.hpp"
+
+#include "evolutionary/Marks.hpp"
+#include "evolutionary/Selection.hpp"
+
+namespace evolutionary
+{
+namespace GA
+{
+
+namespace
+{
+
+// worst cost - cost, the weight of an individual on the roulette wheel
+void wheelWeights(const float* costs, int size, std::vector<double>& weights)
+{
+    double worst = *std::max_element(costs, costs + size);
+    weights.resize(size);
+    for (int k = 0; k < size; k++)
+        weights[k] = worst - costs[k];
+}
+
+} // namespace
+
+void AliasTable::build(const double* weights, int n)
+{
+    mProbability.resize(n);
+    mAlias.resize(n);
+    mSmall.clear();
+    mLarge.clear();
+
+    double total = std::accumulate(weights, weights + n, 0.0);
+
+    // every column holds 1 after scaling, the small ones are topped up by a large one
+    for (int i = 0; i < n; i++)
+    {
+        mProbability[i] = total > 0 ? weights[i] * n / total : 1;
+        mAlias[i] = i;
+        (mProbability[i] < 1 ? mSmall : mLarge).push_back(i);
+    }
+
+    while (!mSmall.empty() && !mLarge.empty())
+    {
+        int small = mSmall.back();
+        int large = mLarge.back();
+        mSmall.pop_back();
+
+        mAlias[small] = large;
+        mProbability[large] -= 1 - mProbability[small];
+        if (mProbability[large] < 1)
+        {
+            mLarge.pop_back();
+            mSmall.push_back(large);
+        }
+    }
+
+    // what is left is 1 but for rounding
+    for (int i: mSmall)
+        mProbability[i] = 1;
+    for (int i: mLarge)
+        mProbability[i] = 1;
+}
+
+int AliasTable::sample() const
+{
+    int i = mhac_random::randint(0, mProbability.size() - 1);
+    return mhac_random::random() < mProbability[i] ? i : mAlias[i];
+}
+
+void Selector::build(SelectionType type, const float* costs, int size, int selectionSize, int picks)
+{
+    mType = type;
+    mCosts = costs;
+    mSize = size;
+    mSelectionSize = std::min(selectionSize, size);
+
+    switch (type)
+    {
+        case SelectionType::TOURNAMENT:
+            break;
+
+        case SelectionType::PROPORTIONAL:
+            wheelWeights(costs, size, mWeights);
+            mAlias.build(mWeights.data(), size);
+            break;
+
+        case SelectionType::STOCHASTIC_UNIVERSAL:
+        {
+            wheelWeights(costs, size, mWeights);
+            double total = std::accumulate(mWeights.begin(), mWeights.end(), 0.0);
+            if (total <= 0)
+            {
+                std::fill(mWeights.begin(), mWeights.end(), 1.0);
+                total = size;
+            }
+
+            // picks pointers step apart from a single random offset
+            picks = std::max(picks, 1);
+            double step = total / picks;
+            double pointer = mhac_random::random(0, step);
+            double cumulative = mWeights[0];
+            int k = 0;
+
+            mPicks.resize(picks);
+            for (int pick = 0; pick < picks; pick++, pointer += step)
+            {
+                while (cumulative <= pointer && k < size - 1)
+                    cumulative += mWeights[++k];
+                mPicks[pick] = k;
+            }
+
+            // the picks come out sorted, shuffled the pairs are not made of neighbours
+            for (int pick = picks - 1; pick > 0; pick--)
+                std::swap(mPicks[pick], mPicks[mhac_random::randint(0, pick)]);
+            break;
+        }
+
+        case SelectionType::RANK:
+        {
+            mOrder.resize(size);
+            std::iota(mOrder.begin(), mOrder.end(), 0);
+            std::stable_sort(mOrder.begin(), mOrder.end(), [costs](int a, int b) {
+                return costs[a] < costs[b];
+            });
+
+            mWeights.resize(size);
+            for (int rank = 0; rank < size; rank++)
+                mWeights[mOrder[rank]] = size - rank;
+            mAlias.build(mWeights.data(), size);
+            break;
+        }
+
+        default:
+            throw std::invalid_argument("unknown selection type");
+    }
+}
+
+int Selector::select(int pick) const
+{
+    switch (mType)
+    {
+        case SelectionType::PROPORTIONAL:
+        case SelectionType::RANK:
+            return mAlias.sample();
+
+        case SelectionType::STOCHASTIC_UNIVERSAL:
+            return mPicks[pick % mPicks.size()];
+
+        default:
+            return tournament();
+    }
+}
+
+int Selector::tournament() const
+{
+    // Floyd's sampling: selectionSize distinct indexes from selectionSize
+    // draws, without shuffling all of them
+    thread_local Marks marks;
+    marks.reset(mSize);
+
+    int indexOfMin = -1;
+    for (int j = mSize - mSelectionSize; j < mSize; j++)
+    {
+        int index = mhac_random::randint(0, j);
+        if (marks.has(index))
+            index = j;
+        marks.add(index);
+
+        if (indexOfMin < 0 || mCosts[index] < mCosts[indexOfMin])
+            indexOfMin = index;
+    }
+    return indexOfMin;
+}
+
+} // namespace GA
+} // namespace evolutionary
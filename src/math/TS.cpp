@@ -1,10 +1,11 @@
 #include <algorithm>
 #include <exception>
 #include <iostream>
+#include <iterator>
 #include <string>
 #include <string>
 #include <utility>
-#include <unordered_set>
+#include <stdexcept>
 
 #include <spdlog/spdlog.h>
 
@@ -19,44 +20,93 @@ namespace math
 namespace TS
 {
 
-TabuSearch::TabuSearch(common::ProblemPtr probType)
-    :mProblem(probType)
+void TabuList::reset(int capacity)
 {
-    globalLogger->flush_on(spdlog::level::err);
-    globalLogger->debug("Initializing TabuSearch");
+    mHashes.assign(std::max(capacity, 1), 0);
+    mSolutions.assign(mHashes.size(), nullptr);
+    mNext = 0;
+    mSize = 0;
+    mCounts.clear();
 }
 
-bool TabuSearch::inTabuList(const common::SolutionPtr& newSol)
+bool TabuList::contains(const common::SolutionPtr& sol, std::uint64_t hash) const
 {
-    return std::any_of(mTabuList.begin(), mTabuList.end(), [&newSol](const common::SolutionPtr& mTabuListMember){
-        return newSol->isEqual(*mTabuListMember);
+    if (hash != 0)
+        return mCounts.count(hash) > 0;
+
+    return std::any_of(mSolutions.begin(), mSolutions.end(), [&sol](const common::SolutionPtr& member) {
+        return member && sol->isEqual(*member);
     });
 }
 
+void TabuList::push(const common::SolutionPtr& sol, std::uint64_t hash)
+{
+    // the oldest entry makes room once the list is full
+    if (mSize == (int) mHashes.size())
+    {
+        std::uint64_t oldest = mHashes[mNext];
+        if (oldest != 0 && --mCounts[oldest] == 0)
+            mCounts.erase(oldest);
+    }
+    else
+    {
+        mSize++;
+    }
+
+    mHashes[mNext] = hash;
+    mSolutions[mNext] = hash != 0 ? nullptr : sol;
+    if (hash != 0)
+        mCounts[hash]++;
+
+    mNext = (mNext + 1) % mHashes.size();
+}
+
+TabuSearch::TabuSearch(common::ProblemPtr probType)
+    :mProblem(probType), mMode(TabuMode::SOLUTION)
+{
+    globalLogger->flush_on(spdlog::level::err);
+    globalLogger->debug("Initializing TabuSearch");
+}
+
 common::SolutionPtr TabuSearch::solve(int iterations, int maxmTabuListSize, int neighborhoodSize)
 {
+    if (mProblem->supportsMoves())
+        return solveWithMoves(iterations, maxmTabuListSize, neighborhoodSize);
+    if (mMode == TabuMode::ATTRIBUTE)
+        throw std::invalid_argument("the ATTRIBUTE tabu mode needs a problem with moves");
+
+    // the latest maxTabuListSize + 1 solutions
+    mTabuList.reset(maxmTabuListSize + 1);
+
     common::SolutionPtr S = mProblem->generateInitialSolution();
-    S->cost = mProblem->evaluateSolution(S);
+    S->cost = mProblem->evaluate(S);
 
     common::SolutionPtr bestS = S;
     bestS->cost = S->cost;
 
-    mTabuList.push_back(S);
+    mTabuList.push(S, S->hash());
 
     for (int iter = 0; iter < iterations; iter++)
     {
         common::SolutionPtr targetNeighbor = mProblem->generateNewSolution(S);
-        targetNeighbor->cost = mProblem->evaluateSolution(targetNeighbor);
+        targetNeighbor->cost = mProblem->evaluate(targetNeighbor);
+        std::uint64_t targetHash = targetNeighbor->hash();
 
         for (int i = 0; i < neighborhoodSize; i++)
         {
             common::SolutionPtr newNeighbor = mProblem->generateNewSolution(S);
-            newNeighbor->cost =  mProblem->evaluateSolution(newNeighbor);
+            newNeighbor->cost =  mProblem->evaluate(newNeighbor);
 
-            if (!inTabuList(newNeighbor) && newNeighbor->cost < targetNeighbor->cost)
+            // only hashed when it would be taken
+            if (newNeighbor->cost < targetNeighbor->cost)
             {
-                targetNeighbor = newNeighbor;
-                targetNeighbor->cost = newNeighbor->cost;
+                std::uint64_t hash = newNeighbor->hash();
+                if (!mTabuList.contains(newNeighbor, hash))
+                {
+                    targetNeighbor = newNeighbor;
+                    targetNeighbor->cost = newNeighbor->cost;
+                    targetHash = hash;
+                }
             }
         }
 
@@ -64,13 +114,7 @@ common::SolutionPtr TabuSearch::solve(int iterations, int maxmTabuListSize, int
         {
             S = targetNeighbor;
             S->cost = targetNeighbor->cost;
-
-            if ((int) mTabuList.size() > maxmTabuListSize)
-            {
-                mTabuList.erase(mTabuList.begin());
-            }
-
-            mTabuList.push_back(S);
+            mTabuList.push(S, targetHash);
         }
 
         if (S->cost < bestS->cost)
@@ -79,10 +123,138 @@ common::SolutionPtr TabuSearch::solve(int iterations, int maxmTabuListSize, int
             bestS->cost = S->cost;
             globalLogger->debug("Found better solution with cost: " + std::to_string(bestS->cost));
         }
+
+        if (mProblem->shouldStop(bestS->cost))
+            break;
     }
 
+    mProblem->improveSolution(bestS);
+
     return bestS;
 }
 
+bool TabuSearch::isTabu(const common::SolutionPtr& S, std::uint64_t hash, const common::Move& move, int iter, std::uint64_t& after)
+{
+    if (mMode == TabuMode::ATTRIBUTE)
+    {
+        auto it = mTabuUntil.find(mProblem->moveAttribute(S, move));
+        return it != mTabuUntil.end() && it->second >= iter;
+    }
+
+    if (hash != 0)
+    {
+        after = mProblem->hashAfterMove(S, hash, move);
+        return mTabuList.contains(S, after);
+    }
+
+    // without hashes the neighbor has to be made to be compared
+    after = 0;
+    mProblem->applyMove(S, move);
+    bool tabu = mTabuList.contains(S, 0);
+    mProblem->undoMove(S, move);
+    return tabu;
+}
+
+common::SolutionPtr TabuSearch::solveWithMoves(int iterations, int maxmTabuListSize, int neighborhoodSize)
+{
+    // the latest maxTabuListSize + 1 solutions, or the attributes of the
+    // moves of the latest maxTabuListSize iterations
+    mTabuList.reset(maxmTabuListSize + 1);
+    mTabuUntil.clear();
+
+    common::SolutionPtr S = mProblem->generateInitialSolution();
+    S->cost = mProblem->evaluate(S);
+    double cost = S->cost;
+
+    // S changes in place, its hash along with it
+    std::uint64_t hash = mMode == TabuMode::SOLUTION ? S->hash() : 0;
+    if (mMode == TabuMode::SOLUTION)
+        mTabuList.push(hash != 0 ? S : S->clone(), hash);
+
+    std::vector<std::pair<float, common::Move>> neighbors(neighborhoodSize);
+
+    for (int iter = 0; iter < iterations; iter++)
+    {
+        // at most one attribute becomes tabu per iteration, so dropping the
+        // expired ones every tenure iterations keeps at most 2 * tenure
+        if (mMode == TabuMode::ATTRIBUTE && iter % std::max(maxmTabuListSize, 1) == 0)
+        {
+            for (auto it = mTabuUntil.begin(); it != mTabuUntil.end(); )
+                it = it->second < iter ? mTabuUntil.erase(it) : std::next(it);
+        }
+
+        common::Move targetMove = mProblem->generateMove(S);
+        float targetDelta = mProblem->evaluateMove(S, targetMove);
+
+        for (int i = 0; i < neighborhoodSize; i++)
+        {
+            neighbors[i].second = mProblem->generateMove(S);
+            neighbors[i].first = mProblem->evaluateMove(S, neighbors[i].second);
+        }
+
+        std::sort(neighbors.begin(), neighbors.end(), [](const std::pair<float, common::Move>& a, const std::pair<float, common::Move>& b) {
+            return a.first < b.first;
+        });
+
+        // only improving neighbors are ever accepted, so the tabu check is
+        // done lazily from the best one up
+        bool accepted = false;
+        common::Move move;
+        float delta = 0;
+        std::uint64_t after = 0;
+        for (int i = 0; i < neighborhoodSize && neighbors[i].first < std::min(targetDelta, 0.0f); i++)
+        {
+            if (!isTabu(S, hash, neighbors[i].second, iter, after))
+            {
+                move = neighbors[i].second;
+                delta = neighbors[i].first;
+                accepted = true;
+                break;
+            }
+        }
+
+        if (!accepted && targetDelta < 0)
+        {
+            move = targetMove;
+            delta = targetDelta;
+            accepted = true;
+            if (mMode == TabuMode::SOLUTION && hash != 0)
+                after = mProblem->hashAfterMove(S, hash, move);
+        }
+
+        if (accepted)
+        {
+            // the attribute is taken before the move changes S
+            if (mMode == TabuMode::ATTRIBUTE)
+                mTabuUntil[mProblem->moveAttribute(S, move)] = iter + maxmTabuListSize;
+
+            mProblem->applyMove(S, move);
+            cost += delta;
+            S->cost = cost;
+
+            if (mMode == TabuMode::SOLUTION)
+            {
+                hash = after;
+                mTabuList.push(hash != 0 ? S : S->clone(), hash);
+            }
+            globalLogger->debug("Found better solution with cost: {}", S->cost);
+        }
+
+        if (mProblem->shouldStop(S->cost))
+            break;
+    }
+
+    // S only ever moves to better neighbors, so it is also the best solution
+    S->cost = mProblem->evaluate(S);
+    mProblem->improveSolution(S);
+
+    return S;
+}
+
+void TabuSearch::setTabuMode(TabuMode mode)
+{
+    mMode = mode;
+}
+
 } // namespace TS
 } // namespace math
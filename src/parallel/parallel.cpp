@@ -0,0 +1,102 @@
+#include <algorithm>
+
+#include "parallel/parallel.hpp"
+
+namespace mhac_parallel
+{
+
+int threadCount(int requested)
+{
+    if (requested > 0)
+        return requested;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+ThreadPool::ThreadPool(int threads)
+{
+    for (int i = 1; i < threads; i++)
+        mWorkers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mStart.notify_all();
+
+    for (std::thread& worker: mWorkers)
+        worker.join();
+}
+
+void ThreadPool::run(int count, const std::function<void(int)>& body)
+{
+    if (mWorkers.empty() || count <= 1)
+    {
+        for (int i = 0; i < count; i++)
+            body(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mBody = &body;
+        mCount = count;
+        mNext = 0;
+        mActive = mWorkers.size();
+        mError = nullptr;
+        mRound++;
+    }
+    mStart.notify_all();
+
+    drain();
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mDone.wait(lock, [this]() { return mActive == 0; });
+    mBody = nullptr;
+
+    if (mError)
+        std::rethrow_exception(mError);
+}
+
+void ThreadPool::work()
+{
+    long long round = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mStart.wait(lock, [this, round]() { return mStop || mRound != round; });
+            if (mStop)
+                return;
+            round = mRound;
+        }
+
+        drain();
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (--mActive == 0)
+            mDone.notify_one();
+    }
+}
+
+void ThreadPool::drain()
+{
+    for (int i = mNext++; i < mCount; i = mNext++)
+    {
+        try
+        {
+            (*mBody)(i);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (!mError)
+                mError = std::current_exception();
+            mNext = mCount;
+        }
+    }
+}
+
+} // namespace mhac_parallel
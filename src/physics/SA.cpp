@@ -49,8 +49,12 @@ float SimulatedAnnealing::updateTemp(float T)
 common::SolutionPtr SimulatedAnnealing::solve(float maxT, float minT, float k)
 {
     mK = k;
+
+    if (mProblem->supportsMoves())
+        return solveWithMoves(maxT, minT);
+
     common::SolutionPtr S = mProblem->generateInitialSolution();
-    S->cost = mProblem->evaluateSolution(S);
+    S->cost = mProblem->evaluate(S);
 
     common::SolutionPtr bestS = S;
     bestS->cost = S->cost;
@@ -60,7 +64,7 @@ common::SolutionPtr SimulatedAnnealing::solve(float maxT, float minT, float k)
     while (T > minT)
     {
         common::SolutionPtr primeS = mProblem->generateNewSolution(S);
-        primeS->cost = mProblem->evaluateSolution(primeS);
+        primeS->cost = mProblem->evaluate(primeS);
 
         if (accept(S->cost, primeS->cost, T))
         {
@@ -75,9 +79,70 @@ common::SolutionPtr SimulatedAnnealing::solve(float maxT, float minT, float k)
             globalLogger->info("Found better solution with cost {}", bestS->cost);
         }
 
+        if (mProblem->shouldStop(bestS->cost))
+            break;
+
+        T = updateTemp(T);
+    }
+
+    mProblem->improveSolution(bestS);
+
+    return bestS;
+}
+
+common::SolutionPtr SimulatedAnnealing::solveWithMoves(float maxT, float minT)
+{
+    common::SolutionPtr S = mProblem->generateInitialSolution();
+    S->cost = mProblem->evaluate(S);
+
+    // S is changed in place, the best solution is only copied out of it
+    // right before a worsening move takes S away from the best cost seen
+    common::SolutionPtr bestS = nullptr;
+    bool atBest = true;
+
+    // running costs are kept in double so the deltas don't drift
+    double cost = S->cost;
+    double bestCost = cost;
+
+    float T = maxT;
+
+    while (T > minT)
+    {
+        common::Move move = mProblem->generateMove(S);
+        float delta = mProblem->evaluateMove(S, move);
+
+        if (accept(cost, cost + delta, T))
+        {
+            if (atBest && delta > 0)
+            {
+                bestS = S->clone();
+                atBest = false;
+            }
+
+            mProblem->applyMove(S, move);
+            cost += delta;
+            S->cost = cost;
+
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                atBest = true;
+                globalLogger->info("Found better solution with cost {}", bestCost);
+            }
+        }
+
+        if (mProblem->shouldStop(bestCost))
+            break;
+
         T = updateTemp(T);
     }
 
+    if (atBest)
+        bestS = S;
+
+    bestS->cost = mProblem->evaluate(bestS);
+    mProblem->improveSolution(bestS);
+
     return bestS;
 }
 
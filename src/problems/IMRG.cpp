@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <dirent.h>
+
+#include "problems/IMRG.hpp"
+
+namespace problems
+{
+namespace jss
+{
+
+namespace
+{
+
+std::string readFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("Cannot open imrg file " + path);
+
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+// the integers on one line, parsed with strtol straight from the buffer
+void parseLine(const char* begin, const char* end, std::vector<long long>& values)
+{
+    values.clear();
+    const char* pos = begin;
+    while (pos < end)
+    {
+        while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r'))
+            pos++;
+        if (pos == end)
+            break;
+
+        char* next = nullptr;
+        values.push_back(std::strtoll(pos, &next, 10));
+        if (next == pos || next > end)
+            throw std::invalid_argument("expected a number");
+        pos = next;
+    }
+}
+
+std::string stem(const std::string& path)
+{
+    size_t slash = path.find_last_of('/');
+    std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    size_t dot = name.find_last_of('.');
+    return dot == std::string::npos ? name : name.substr(0, dot);
+}
+
+} // namespace
+
+Instance readIMRG(const std::string& path)
+{
+    std::string data = readFile(path);
+    Instance instance;
+    instance.name = stem(path);
+
+    int machines = -1, products = -1;
+    std::vector<int> times;
+    std::vector<long long> values;
+    int lineNumber = 0;
+
+    const char* pos = data.c_str();
+    const char* end = pos + data.size();
+    while (pos < end)
+    {
+        const char* eol = std::find(pos, end, '\n');
+        lineNumber++;
+
+        try
+        {
+            parseLine(pos, eol, values);
+        }
+        catch (const std::invalid_argument& e)
+        {
+            throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": " + e.what());
+        }
+        pos = eol == end ? end : eol + 1;
+
+        if (values.empty())
+            continue;
+
+        if (machines < 0)
+        {
+            if (values.size() != 2 || values[0] <= 0 || values[1] <= 0)
+                throw std::runtime_error(path + ": expected \"machines products\" on the first line");
+            machines = values[0];
+            products = values[1];
+            times.reserve((size_t) machines * products);
+            continue;
+        }
+
+        // the first row tells whether the file has due dates, the rest must agree
+        bool dueDate = (int) values.size() == machines + 1;
+        if (times.empty() && !dueDate && (int) values.size() != machines)
+            throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": expected " + std::to_string(machines) + " processing times");
+        if (!times.empty() && (int) values.size() != machines + (instance.dueDates.empty() ? 0 : 1))
+            throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": row length differs from the first one");
+        if ((int) (times.size() / machines) == products)
+            throw std::runtime_error(path + ": more than " + std::to_string(products) + " products");
+
+        times.insert(times.end(), values.begin(), values.begin() + machines);
+        if (dueDate)
+            instance.dueDates.push_back(values[machines]);
+    }
+
+    if (machines < 0 || (int) (times.size() / machines) != products)
+        throw std::runtime_error(path + ": expected " + std::to_string(std::max(products, 0)) + " products");
+
+    instance.products = ProcessingTimes(products, machines, times);
+    return instance;
+}
+
+std::vector<Instance> readIMRGDirectory(const std::string& directory)
+{
+    DIR* dir = opendir(directory.c_str());
+    if (!dir)
+        throw std::runtime_error("Cannot open directory " + directory);
+
+    std::vector<std::string> names;
+    while (dirent* entry = readdir(dir))
+    {
+        std::string name = entry->d_name;
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".txt") == 0)
+            names.push_back(name);
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+
+    std::vector<Instance> instances;
+    instances.reserve(names.size());
+    for (const std::string& name: names)
+        instances.push_back(readIMRG(directory + "/" + name));
+    return instances;
+}
+
+std::map<std::string, long long> readIMRGBest(const std::string& path)
+{
+    std::istringstream lines(readFile(path));
+    std::map<std::string, long long> best;
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(lines, line))
+    {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        size_t comma = line.find(',');
+        if (line.empty() || (lineNumber == 1 && line.compare(0, 9, "Instance,") == 0))
+            continue;
+
+        char* next = nullptr;
+        const char* value = line.c_str() + comma + 1;
+        long long min = comma == std::string::npos ? 0 : std::strtoll(value, &next, 10);
+        if (comma == std::string::npos || next == value)
+            throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": expected Instance,Min");
+
+        best[line.substr(0, comma)] = min;
+    }
+
+    return best;
+}
+
+} // namespace jss
+} // namespace problems
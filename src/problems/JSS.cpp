@@ -1,4 +1,8 @@
+#include <algorithm>
+#include <limits>
+#include <numeric>
 #include <queue>
+#include <stdexcept>
 #include <memory>
 #include <string>
 
@@ -13,17 +17,179 @@ namespace problems
 namespace jss
 {
 
+namespace
+{
+
+// completion times of the job on the next position, given the row of the
+// previous position (nullptr for the first one)
+inline void nextRow(const int* times, int m, const int* previous, int* row)
+{
+    int left = 0;
+    for (int machine = 0; machine < m; machine++)
+    {
+        int start = previous ? std::max(left, previous[machine]) : left;
+        left = row[machine] = start + times[machine];
+    }
+}
+
+// rows of positions from on, the ones before are kept as they are
+void computeCompletionTimes(const JSSP& problem, const std::vector<int>& schedule, int from, std::vector<int>& times)
+{
+    int n = schedule.size();
+    int m = problem.products.machines();
+    times.resize((size_t) n * m);
+
+    for (int t = from; t < n; t++)
+        nextRow(problem.products.product(schedule[t]), m, t > 0 ? &times[(size_t) (t - 1) * m] : nullptr, &times[(size_t) t * m]);
+}
+
+// row scratch of totalCompletionTime, windowDelta and insertionPoint, none
+// of which calls another; grows to the most rows * machines the thread has
+// needed, then never allocates
+int* scratchRows(int size)
+{
+    thread_local std::vector<int> rows;
+    if ((int) rows.size() < size)
+        rows.resize(size);
+    return rows.data();
+}
+
+// change of the total completion time when the jobs on positions from..to
+// become jobAt(from)..jobAt(to); past to the jobs are the old ones, so the
+// recomputation stops at the first row that matches the old table again
+template <typename JobAt>
+long long windowDelta(const JSSP& problem, const std::vector<int>& times, int n, int from, int to, JobAt jobAt)
+{
+    int m = problem.products.machines();
+    int* rows = scratchRows(2 * m);
+    int* row = rows;
+    const int* previous = from > 0 ? &times[(size_t) (from - 1) * m] : nullptr;
+    long long delta = 0;
+
+    for (int t = from; t < n; t++)
+    {
+        const int* old = &times[(size_t) t * m];
+        nextRow(problem.products.product(jobAt(t)), m, previous, row);
+        delta += row[m - 1] - old[m - 1];
+
+        if (t > to && std::equal(row, row + m, old))
+            break;
+
+        previous = row;
+        row = row == rows ? rows + m : rows;
+    }
+
+    return delta;
+}
+
+// position among 0..rest.size() where inserting job gives the lowest total
+// completion time below best, -1 when there is none; heads is the completion
+// table of rest and prefix[t] its total up to position t. Position skip is
+// not tried, best is lowered to the total found.
+int insertionPoint(const JSSP& problem, const std::vector<int>& rest, const std::vector<int>& heads,
+                   const std::vector<long long>& prefix, int job, int skip, long long& best)
+{
+    int r = rest.size();
+    int m = problem.products.machines();
+    long long restTotal = r > 0 ? prefix[r - 1] : 0;
+
+    // inserting the job can only delay the ones after it, so the old
+    // completion times of the rest bound every candidate from below
+    int* rows = scratchRows(3 * m);
+    int* inserted = rows;
+    int bestPosition = -1;
+
+    for (int k = 0; k <= r; k++)
+    {
+        if (k == skip)
+            continue;
+
+        const int* previous = k > 0 ? &heads[(size_t) (k - 1) * m] : nullptr;
+        nextRow(problem.products.product(job), m, previous, inserted);
+        if (restTotal + inserted[m - 1] >= best)
+            continue;
+
+        long long total = (k > 0 ? prefix[k - 1] : 0) + inserted[m - 1];
+        int* row = rows + m;
+        const int* last = inserted;
+        bool pruned = false;
+
+        for (int t = k; t < r; t++)
+        {
+            const int* old = &heads[(size_t) t * m];
+            nextRow(problem.products.product(rest[t]), m, last, row);
+            total += row[m - 1];
+
+            if (std::equal(row, row + m, old))
+            {
+                total += restTotal - prefix[t];
+                break;
+            }
+            if (total + restTotal - prefix[t] >= best)
+            {
+                pruned = true;
+                break;
+            }
+
+            last = row;
+            row = row == rows + m ? rows + 2 * m : rows + m;
+        }
+
+        if (!pruned && total < best)
+        {
+            best = total;
+            bestPosition = k;
+        }
+    }
+
+    return bestPosition;
+}
+
+// hash of schedule s after move, given hash, the one of s now
+std::uint64_t hashAfterRearrange(const std::vector<int>& s, std::uint64_t hash, const common::Move& move, Neighborhood type)
+{
+    int i = move.i;
+    int j = move.j;
+
+    if (type == Neighborhood::SWAP)
+        return common::hashChange(common::hashChange(hash, i, s[i], s[j]), j, s[j], s[i]);
+
+    // the job on i goes to j, the ones in between shift by one towards i
+    int step = i < j ? 1 : -1;
+    for (int t = i; t != j; t += step)
+        hash = common::hashChange(hash, t, s[t], s[t + step]);
+    return common::hashChange(hash, j, s[j], s[i]);
+}
+
+} // namespace
+
 bool JSSS::isEqual(const common::Solution & other) const
 {
     const JSSS* otherJSSS = dynamic_cast<const JSSS*>(&other);
     return this->schedule == otherJSSS->schedule;
 }
 
+common::SolutionPtr JSSS::clone() const
+{
+    return std::make_shared<JSSS>(*this);
+}
+
 int JSSS::getSize() const
 {
     return this->schedule.size();
 }
 
+std::uint64_t JSSS::hash() const
+{
+    std::uint64_t hash = storedHash.get();
+    if (hash == 0)
+    {
+        hash = common::hashSequence(schedule.data(), schedule.size());
+        storedHash.set(hash);
+    }
+    return hash;
+}
+
 std::string JSSS::print()
 {
     std::string s;
@@ -34,65 +200,147 @@ std::string JSSS::print()
     return s;
 }
 
-JSSP::JSSP(const TimeMatrix& products)
+ProcessingTimes::ProcessingTimes(const TimeMatrix& products)
+    : mProducts(products.size()),
+      mMachines(products.empty() ? 0 : products[0].size())
+{
+    mRows.reserve((size_t) mProducts * mMachines);
+    for (const ProductVec& product: products)
+    {
+        if ((int) product.size() != mMachines)
+            throw std::invalid_argument("every product needs a processing time on each of the " + std::to_string(mMachines) + " machines");
+        mRows.insert(mRows.end(), product.begin(), product.end());
+    }
+}
+
+ProcessingTimes::ProcessingTimes(int products, int machines, const std::vector<int>& rowMajor)
+    : mProducts(products),
+      mMachines(machines),
+      mRows(rowMajor)
+{
+    if (products < 0 || machines < 0 || rowMajor.size() != (size_t) products * machines)
+        throw std::invalid_argument("expected " + std::to_string(products) + " x " + std::to_string(machines) + " processing times");
+}
+
+TimeMatrix ProcessingTimes::toMatrix() const
+{
+    TimeMatrix matrix;
+    for (int p = 0; p < mProducts; p++)
+        matrix.emplace_back(product(p), product(p) + mMachines);
+    return matrix;
+}
+
+JSSP::JSSP(const ProcessingTimes& products)
+{
+    setProducts(products);
+}
+
+JSSP::JSSP(const Instance& instance)
+    : JSSP(instance.products)
+{}
+
+void JSSP::setProducts(const ProcessingTimes& products)
 {
     this->products = products;
+    setInitialSchedule(initialSchedule);
+
+    if (evaluationCache)
+        evaluationCache->clear();
 }
 
-float JSSP::evaluateSolution(common::SolutionPtr sol)
+long long JSSP::totalCompletionTime(const std::vector<int>& schedule, int* row) const
 {
-    JSSSPtr sol_sequence = std::dynamic_pointer_cast<JSSS>(sol);
-    
-    int num_products = products.size();
-    int num_machines = products[0].size();
-    TimeMatrix completion_times(num_products, ProductVec(num_machines, 0));
-    int total_completition_time = 0;
+    return totalCompletionTime(schedule.data(), schedule.size(), row);
+}
 
-    for (int productIndex = 0; productIndex < num_products; productIndex++) {
-        int product = sol_sequence->schedule[productIndex];
+long long JSSP::totalCompletionTime(const int* schedule, int n, int* row) const
+{
+    // row[machine] is the completion time of the last scheduled job on that
+    // machine, updated in place job after job
+    int m = products.machines();
+    std::fill(row, row + m, 0);
+    long long total = 0;
 
-        for (int machine = 0; machine < num_machines; machine++) {
-            if (productIndex == 0) {
-                completion_times[productIndex][machine] = this->products[product][machine];
-            }
-            else {
-                if (machine == 0) {
-                    completion_times[productIndex][machine] =
-                        completion_times[productIndex-1][machine] + this->products[product][machine];
-                }
-                else {
-                    completion_times[productIndex][machine] = this->products[product][machine] +
-                        std::max(completion_times[productIndex][machine-1], completion_times[productIndex-1][machine]);
-                }
-            }
+    for (int k = 0; k < n; k++)
+    {
+        const int* p = products.product(schedule[k]);
+        row[0] += p[0];
+        for (int machine = 1; machine < m; machine++)
+            row[machine] = std::max(row[machine], row[machine - 1]) + p[machine];
 
-            if (machine == num_machines - 1) {
-                total_completition_time += completion_times[productIndex][machine];
-            }
-        }
+        total += row[m - 1];
     }
 
-    globalLogger->debug("Schedule: " + sol_sequence->print());
+    return total;
+}
 
-    globalLogger->debug("Completition times:");
+float JSSP::evaluateSolution(common::SolutionPtr sol)
+{
+    JSSSPtr jss = std::dynamic_pointer_cast<JSSS>(sol);
+    return totalCompletionTime(jss->schedule, scratchRows(products.machines()));
+}
 
-    for (int i = 0; i < num_products; i++) {
-        std::string row;
-        for (int j = 0; j < num_machines; j++) {
-            row += std::to_string(completion_times[i][j]) + " ";
-        }
-        globalLogger->debug(row);
+float JSSP::evaluateSchedule(const int* schedule) const
+{
+    return totalCompletionTime(schedule, products.size(), scratchRows(products.machines()));
+}
+
+std::vector<int> JSSP::constructSchedule(InitialSchedule type) const
+{
+    int n = products.size();
+    int m = products.machines();
+    if (type == InitialSchedule::RANDOM)
+        return mhac_random::sample(n, n);
+
+    std::vector<long long> work(n, 0);
+    std::vector<int> order(n);
+    for (int job = 0; job < n; job++)
+    {
+        order[job] = job;
+        const int* p = products.product(job);
+        work[job] = std::accumulate(p, p + m, 0LL);
+    }
+    std::stable_sort(order.begin(), order.end(), [&work](int a, int b) {
+        return work[a] > work[b];
+    });
+
+    // the partial schedule with its completion table and running totals,
+    // after an insertion only the rows from the new job on change
+    std::vector<int> schedule;
+    std::vector<int> heads;
+    std::vector<long long> prefix;
+    schedule.reserve(n);
+    prefix.reserve(n);
+
+    for (int job: order)
+    {
+        long long best = std::numeric_limits<long long>::max();
+        int k = insertionPoint(*this, schedule, heads, prefix, job, -1, best);
+
+        schedule.insert(schedule.begin() + k, job);
+        computeCompletionTimes(*this, schedule, k, heads);
+        prefix.resize(schedule.size());
+        for (int t = k; t < (int) schedule.size(); t++)
+            prefix[t] = (t > 0 ? prefix[t - 1] : 0) + heads[(size_t) t * m + m - 1];
     }
 
-    globalLogger->debug("Total cost: " + std::to_string(total_completition_time));
+    return schedule;
+}
 
-    return total_completition_time;
+void JSSP::setInitialSchedule(InitialSchedule type)
+{
+    initialSchedule = type;
+    if (type == InitialSchedule::RANDOM)
+        seedSchedule.clear();
+    else
+        seedSchedule = constructSchedule(type);
 }
 
 common::SolutionPtr JSSP::generateInitialSolution()
 {
     JSSSPtr tss = std::make_shared<JSSS>();
-    tss->schedule = mhac_random::sample(products.size(), products.size());
+    bool seeded = !seedSchedule.empty() && mhac_random::random() < seedRatio;
+    tss->schedule = seeded ? seedSchedule : constructSchedule(InitialSchedule::RANDOM);
     return tss;
 }
 
@@ -105,82 +353,222 @@ common::SolutionPtr JSSP::generateNewSolution(common::SolutionPtr initialSol)
     std::vector<int> indexes = mhac_random::sample(jssInitial->getSize(), 2);
     int i = indexes[0];
     int j = indexes[1];
-    
+
+    // the new hash follows from the initial one, when that is known
+    std::uint64_t hash = jssInitial->storedHash.get();
+    if (hash != 0)
+        jssNew->storedHash.set(hashAfterRearrange(jssNew->schedule, hash, common::Move(i, j), Neighborhood::SWAP));
+
     std::swap(jssNew->schedule[i], jssNew->schedule[j]);
 
     return jssNew;
 }
 
-GA_JSSP::GA_JSSP(const TimeMatrix& products) : JSSP(products)
-{}
+void JSSP::updateCompletionTimes(JSSS& jss) const
+{
+    if (jss.completionSchedule != jss.schedule)
+    {
+        computeCompletionTimes(*this, jss.schedule, 0, jss.completionTimes);
+        jss.completionSchedule = jss.schedule;
+    }
+}
 
-void GA_JSSP::repair(common::SolutionPtr sol)
+common::Move JSSP::generateMove(common::SolutionPtr sol)
+{
+    int n = sol->getSize();
+    common::Move move(mhac_random::randint(0, n - 1), mhac_random::randint(0, n - 2));
+    if (move.j >= move.i)
+        move.j++;
+
+    return move;
+}
+
+float JSSP::evaluateMove(common::SolutionPtr sol, const common::Move& move)
 {
     JSSSPtr jss = std::dynamic_pointer_cast<JSSS>(sol);
+    updateCompletionTimes(*jss);
 
-    int size = jss->getSize();
-    std::vector<int>& schedule = jss->schedule;
-
-    std::unordered_set<int> seen;
-    std::vector<int> duplicates;
-    std::vector<bool> isPresent(size, false);
-
-    // Identify duplicates and check which elements are present
-    for (int i = 0; i < size; ++i) {
-        if (seen.find(schedule[i]) != seen.end()) {
-            // This machine is a duplicate
-            duplicates.push_back(i);
-        } else {
-            seen.insert(schedule[i]);
-            isPresent[schedule[i]] = true;
-        }
+    const std::vector<int>& s = jss->schedule;
+    int n = s.size();
+    int i = move.i;
+    int j = move.j;
+    int from = std::min(i, j);
+    int to = std::max(i, j);
+
+    if (neighborhood == Neighborhood::SWAP)
+    {
+        return windowDelta(*this, jss->completionTimes, n, from, to, [&s, i, j](int t) {
+            return t == i ? s[j] : (t == j ? s[i] : s[t]);
+        });
     }
 
-    // Find missing elements
-    std::queue<int> missing;
-    for (int i = 0; i < size; ++i) {
-        if (!isPresent[i]) {
-            missing.push(i);
-        }
+    // the jobs between the two positions shift by one towards i
+    return windowDelta(*this, jss->completionTimes, n, from, to, [&s, i, j](int t) {
+        if (t == j)
+            return s[i];
+        if (i < j && t >= i && t < j)
+            return s[t + 1];
+        if (i > j && t > j && t <= i)
+            return s[t - 1];
+        return s[t];
+    });
+}
+
+void JSSP::applyMove(common::SolutionPtr sol, const common::Move& move)
+{
+    rearrange(*std::dynamic_pointer_cast<JSSS>(sol), move, neighborhood);
+}
+
+void JSSP::rearrange(JSSS& jss, const common::Move& move, Neighborhood type) const
+{
+    std::vector<int>& s = jss.schedule;
+    bool cached = jss.completionSchedule == s;
+
+    std::uint64_t hash = jss.storedHash.get();
+    if (hash != 0)
+        jss.storedHash.set(hashAfterRearrange(s, hash, move, type));
+
+    if (type == Neighborhood::SWAP)
+        std::swap(s[move.i], s[move.j]);
+    else if (move.i < move.j)
+        std::rotate(s.begin() + move.i, s.begin() + move.i + 1, s.begin() + move.j + 1);
+    else
+        std::rotate(s.begin() + move.j, s.begin() + move.i, s.begin() + move.i + 1);
+
+    // keep the table in step when it was, only the moved part changes
+    if (cached)
+    {
+        computeCompletionTimes(*this, s, std::min(move.i, move.j), jss.completionTimes);
+        jss.completionSchedule = s;
     }
+}
+
+void JSSP::undoMove(common::SolutionPtr sol, const common::Move& move)
+{
+    // a swap is its own inverse, an insertion is undone by the opposite one
+    if (neighborhood == Neighborhood::SWAP)
+        applyMove(sol, move);
+    else
+        applyMove(sol, common::Move(move.j, move.i));
+}
 
-    // Replace duplicates with missing elements
-    for (int idx : duplicates) {
-        if (!missing.empty()) {
-            schedule[idx] = missing.front();
-            missing.pop();
+std::uint64_t JSSP::hashAfterMove(common::SolutionPtr sol, std::uint64_t hash, const common::Move& move)
+{
+    return hashAfterRearrange(std::dynamic_pointer_cast<JSSS>(sol)->schedule, hash, move, neighborhood);
+}
+
+std::uint64_t JSSP::moveAttribute(common::SolutionPtr sol, const common::Move& move)
+{
+    const std::vector<int>& s = std::dynamic_pointer_cast<JSSS>(sol)->schedule;
+    if (neighborhood == Neighborhood::INSERTION)
+        return s[move.i];
+
+    unsigned a = std::min(s[move.i], s[move.j]);
+    unsigned b = std::max(s[move.i], s[move.j]);
+    return (std::uint64_t) a << 32 | b;
+}
+
+int JSSP::bestInsertion(common::SolutionPtr sol, int position, float& delta)
+{
+    JSSSPtr jss = std::dynamic_pointer_cast<JSSS>(sol);
+    updateCompletionTimes(*jss);
+
+    const std::vector<int>& s = jss->schedule;
+    const std::vector<int>& times = jss->completionTimes;
+    int n = s.size();
+    int m = products.machines();
+    int job = s[position];
+    delta = 0;
+    if (n < 2)
+        return position;
+
+    // the schedule without the job: rows before position are unchanged
+    std::vector<int> rest(s);
+    rest.erase(rest.begin() + position);
+    std::vector<int> heads(times.begin(), times.begin() + (size_t) position * m);
+    computeCompletionTimes(*this, rest, position, heads);
+
+    // prefix[t]: total completion time of rest[0..t]
+    std::vector<long long> prefix(n - 1);
+    for (int t = 0; t < n - 1; t++)
+        prefix[t] = (t > 0 ? prefix[t - 1] : 0) + heads[(size_t) t * m + m - 1];
+
+    long long current = 0;
+    for (int t = 0; t < n; t++)
+        current += times[(size_t) t * m + m - 1];
+
+    // only a position beating the current schedule is taken
+    long long best = current;
+    int target = insertionPoint(*this, rest, heads, prefix, job, position, best);
+
+    delta = best - current;
+    return target < 0 ? position : target;
+}
+
+float JSSP::insertionLocalSearch(common::SolutionPtr sol)
+{
+    JSSSPtr jss = std::dynamic_pointer_cast<JSSS>(sol);
+    int n = jss->getSize();
+    float gain = 0;
+
+    bool improved = true;
+    while (improved)
+    {
+        improved = false;
+        for (int job: mhac_random::sample(n, n))
+        {
+            int position = std::find(jss->schedule.begin(), jss->schedule.end(), job) - jss->schedule.begin();
+            float delta;
+            int target = bestInsertion(jss, position, delta);
+
+            if (delta < 0)
+            {
+                rearrange(*jss, common::Move(position, target), Neighborhood::INSERTION);
+                gain -= delta;
+                improved = true;
+            }
         }
     }
+
+    return gain;
 }
 
-common::SolutionVec GA_JSSP::crossover(common::SolutionPtr parent1, common::SolutionPtr parent2)
+void JSSP::setLocalSearch(bool enabled)
 {
-    JSSSPtr jss_parent1 = std::dynamic_pointer_cast<JSSS>(parent1);
-    JSSSPtr jss_parent2 = std::dynamic_pointer_cast<JSSS>(parent2);
+    localSearch = enabled;
+}
+
+void JSSP::improveSolution(common::SolutionPtr sol)
+{
+    if (!localSearch)
+        return;
 
-    JSSSPtr outChild1 = std::make_shared<JSSS>();
-    JSSSPtr outChild2 = std::make_shared<JSSS>();
+    insertionLocalSearch(sol);
+    sol->cost = evaluateSolution(sol);
+}
+
+GA_JSSP::GA_JSSP(const ProcessingTimes& products) : JSSP(products)
+{}
 
-    JSSSPtr jss_outChild1 = std::dynamic_pointer_cast<JSSS>(outChild1);
-    JSSSPtr jss_outChild2 = std::dynamic_pointer_cast<JSSS>(outChild2);
+GA_JSSP::GA_JSSP(const Instance& instance) : JSSP(instance)
+{}
 
-    int cutPoint = mhac_random::random(0, jss_parent1->schedule.size() - 1);
+void GA_JSSP::repair(common::SolutionPtr sol)
+{
+    JSSSPtr jss = std::dynamic_pointer_cast<JSSS>(sol);
+    evolutionary::GA::repairPermutation(jss->schedule);
+}
 
-    jss_outChild1->schedule.resize(jss_parent1->schedule.size());
-    jss_outChild2->schedule.resize(jss_parent2->schedule.size());
+common::SolutionVec GA_JSSP::crossover(common::SolutionPtr parent1, common::SolutionPtr parent2)
+{
+    JSSSPtr jss_parent1 = std::dynamic_pointer_cast<JSSS>(parent1);
+    JSSSPtr jss_parent2 = std::dynamic_pointer_cast<JSSS>(parent2);
 
-    // [0, cutPoint)
-    std::copy(jss_parent1->schedule.begin(), jss_parent1->schedule.begin() + cutPoint, jss_outChild1->schedule.begin());
-    std::copy(jss_parent2->schedule.begin(), jss_parent2->schedule.begin() + cutPoint, jss_outChild2->schedule.begin());
+    JSSSPtr jss_outChild1 = std::make_shared<JSSS>();
+    JSSSPtr jss_outChild2 = std::make_shared<JSSS>();
 
-    // [cutPoint, v.size())
-    std::copy(jss_parent2->schedule.begin() + cutPoint, jss_parent2->schedule.end(), jss_outChild1->schedule.begin() + cutPoint);
-    std::copy(jss_parent1->schedule.begin() + cutPoint, jss_parent1->schedule.end(), jss_outChild2->schedule.begin() + cutPoint);
+    evolutionary::GA::permutationCrossover(crossoverType, jss_parent1->schedule, jss_parent2->schedule, jss_outChild1->schedule, jss_outChild2->schedule);
 
-    // repair
-    repair(outChild1);
-    repair(outChild2);
-    
     jss_outChild1->cost = evaluateSolution(jss_outChild1);
     jss_outChild2->cost = evaluateSolution(jss_outChild2);
 
@@ -198,37 +586,96 @@ common::SolutionPtr GA_JSSP::mutation(common::SolutionPtr outChild, float mutati
     if (mhac_random::random() < mutationChance)
     {
         std::swap(tss->schedule[i], tss->schedule[j]);
+        tss->storedHash.reset();
         tss->cost = evaluateSolution(tss);
     }
 
     return tss;
 }
 
-ACO_JSSP::ACO_JSSP(const TimeMatrix& products) : JSSP(products)
+void GA_JSSP::initialGenome(int* genome)
+{
+    bool seeded = !seedSchedule.empty() && mhac_random::random() < seedRatio;
+    std::vector<int> schedule = seeded ? seedSchedule : constructSchedule(InitialSchedule::RANDOM);
+    std::copy(schedule.begin(), schedule.end(), genome);
+}
+
+void GA_JSSP::crossoverGenomes(const int* parent1, const int* parent2, int* child1, int* child2)
+{
+    evolutionary::GA::permutationCrossover(crossoverType, parent1, parent2, child1, child2, products.size());
+}
+
+void GA_JSSP::mutateGenome(int* genome, float mutationChance)
+{
+    int n = products.size();
+    if (n < 2 || mhac_random::random() >= mutationChance)
+        return;
+
+    // two different positions
+    int i = mhac_random::randint(0, n - 1);
+    int j = mhac_random::randint(0, n - 2);
+    if (j >= i)
+        j++;
+    std::swap(genome[i], genome[j]);
+}
+
+void GA_JSSP::improveGenome(int* genome)
+{
+    if (!localSearch)
+        return;
+
+    // the insertion search works on a solution, the one of the thread is reused
+    thread_local JSSSPtr jss = std::make_shared<JSSS>();
+    jss->schedule.assign(genome, genome + products.size());
+    // its completion times may be of another instance
+    jss->completionSchedule.clear();
+    insertionLocalSearch(jss);
+    std::copy(jss->schedule.begin(), jss->schedule.end(), genome);
+}
+
+float GA_JSSP::evaluateGenome(const int* genome)
+{
+    return evaluateSchedule(genome);
+}
+
+common::SolutionPtr GA_JSSP::genomeSolution(const int* genome)
+{
+    JSSSPtr jss = std::make_shared<JSSS>();
+    jss->schedule.assign(genome, genome + products.size());
+    return jss;
+}
+
+ACO_JSSP::ACO_JSSP(const ProcessingTimes& products) : JSSP(products)
+{}
+
+ACO_JSSP::ACO_JSSP(const Instance& instance) : JSSP(instance)
 {}
 
+float ACO_JSSP::heuristic(int i, int j) const
+{
+    const int* p = products.product(j);
+    return 1.0 / std::max(std::accumulate(p, p + products.machines(), 0), 1);
+}
+
 common::SolutionPtr ACO_JSSP::updateAntPath(common::SolutionPtr ant, swarm::ACO::PheromoneMatrixPtr pm, float alpha, float beta)
 {
     JSSSPtr jss = std::dynamic_pointer_cast<JSSS>(ant);
 
+    // tau^alpha * eta^beta, looked up in the solver's cache when it was built for these arguments
+    const swarm::ACO::ChoiceInfo* info = choiceInfo && choiceInfo->matches(*pm, alpha, beta) ? choiceInfo.get() : nullptr;
+    const swarm::ACO::PheromoneMatrix& tau = *pm;
+
     int N = jss->getSize();
     std::vector<float> probabilities(N, 0.0f);
 
-    // TODO: consider using globals or moving to mhac_random
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::discrete_distribution<> dist;
-
     for (int i = 0; i < N - 1; ++i) {
         int currentJob = jss->schedule[i];
         float sum = 0.0f;
 
         for (int j = i + 1; j < N; ++j) {
             int nextJob = jss->schedule[j];
-            float pheromone = std::pow((*pm)(currentJob, nextJob), alpha);
-            float heuristic = (this->products[currentJob][nextJob] == 0) ? 0 : (1.0 / this->products[currentJob][nextJob]);
-            float eta = std::pow(heuristic, beta);
-            probabilities[j] = pheromone * eta;
+            probabilities[j] = info ? (*info)(currentJob, nextJob)
+                                    : std::pow(tau(currentJob, nextJob), alpha) * std::pow(heuristic(currentJob, nextJob), beta);
             sum += probabilities[j];
         }
 
@@ -242,34 +689,42 @@ common::SolutionPtr ACO_JSSP::updateAntPath(common::SolutionPtr ant, swarm::ACO:
         // std::vector<int> indices = mhac_random::sample(N - i - 1, 1); // Get one index from remaining
         // int selectedIndex = indices[0] + i + 1; // Adjust index to be relative to i + 1
 
-        // weighted
-        auto dist = std::discrete_distribution<>(probabilities.begin() + i + 1, probabilities.end());
-        int selectedIndex = i + 1 + dist(gen);
+        // weighted, drawn from mhac_random so ants are reproducible whichever thread builds them
+        float u = mhac_random::random();
+        float cumulative = 0.0f;
+        int selectedIndex = N - 1;
+        for (int j = i + 1; j < N; ++j) {
+            cumulative += probabilities[j];
+            if (u <= cumulative) {
+                selectedIndex = j;
+                break;
+            }
+        }
 
         std::swap(jss->schedule[i + 1], jss->schedule[selectedIndex]);
     }
+    jss->storedHash.reset();
 
     return jss;
 }
 
 void ACO_JSSP::updatePheromoneMatrix(common::SolutionPtr ant, swarm::ACO::PheromoneMatrixPtr pm, float rho)
 {
-    JSSSPtr jss = std::dynamic_pointer_cast<JSSS>(ant);
+    pm->scale(1 - rho); // Evaporate the existing pheromone
+    depositPheromone(ant, *pm, rho);
+}
 
-    float totalJobCompletionTime = evaluateSolution(ant);
-    float deposit = 1.0 / (totalJobCompletionTime);
+void ACO_JSSP::depositPheromone(common::SolutionPtr ant, swarm::ACO::PheromoneMatrix& pm, float weight)
+{
+    JSSSPtr jss = std::dynamic_pointer_cast<JSSS>(ant);
 
-    for (int i = 0; i < pm->getSize(); i++) {
-        for (int j = 0; j < pm->getSize(); j++) {
-            (*pm)(i, j) *= (1 - rho); // Evaporate the existing pheromone
-        }
-    }
+    float deposit = weight / ant->cost;
 
     // Deposit new pheromones based on the ant's path
-    for (size_t k = 0; k < jss->schedule.size() - 1; ++k) {
+    for (size_t k = 0; k + 1 < jss->schedule.size(); ++k) {
         int i = jss->schedule[k];
         int j = jss->schedule[k + 1];
-        (*pm)(i, j) += deposit; // Add new pheromones based on solution quality
+        pm.add(i, j, deposit); // Add new pheromones based on solution quality
     }
 }
 
@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <cmath>
 #include <memory>
+#include <stdexcept>
 #include <string>
 
 #include "common.hpp"
@@ -7,23 +9,67 @@
 #include "logger/logger.hpp"
 
 #include "problems/TSP.hpp"
+#include "problems/TSPKernels.hpp"
+#include "problems/TSPConstruction.hpp"
 
 namespace problems
 {
 namespace tsp
 {
 
+namespace
+{
+
+// a tour hashes as the xor of a key per undirected edge, so the rotations
+// and the reversal of a cycle hash the same, and a 2-opt move, replacing
+// edges (a, b) and (c, d) by (a, c) and (b, d), changes four keys
+std::uint64_t edgeKey(int a, int b)
+{
+    return common::positionKey(std::min(a, b), std::max(a, b));
+}
+
+std::uint64_t hashTour(const int* tour, int n)
+{
+    std::uint64_t hash = 0;
+    for (int k = 0; k < n; k++)
+        hash ^= edgeKey(tour[k], tour[(k + 1) % n]);
+    return hash;
+}
+
+std::uint64_t hashAfterTwoOpt(std::uint64_t hash, int a, int b, int c, int d)
+{
+    return hash ^ edgeKey(a, b) ^ edgeKey(c, d) ^ edgeKey(a, c) ^ edgeKey(b, d);
+}
+
+} // namespace
+
 bool TSS::isEqual(const Solution& other) const
 {
     const TSS* otherTSS = dynamic_cast<const TSS*>(&other);
     return otherTSS && this->tour == otherTSS->tour;
 }
 
+common::SolutionPtr TSS::clone() const
+{
+    return std::make_shared<TSS>(*this);
+}
+
 int TSS::getSize() const
 {
     return this->tour.size();
 }
 
+std::uint64_t TSS::hash() const
+{
+    std::uint64_t hash = storedHash.get();
+    if (hash == 0)
+    {
+        hash = hashTour(tour.data(), tour.size());
+        storedHash.set(hash);
+    }
+    return hash;
+}
+
 std::string TSS::print()
 {
     std::string s;
@@ -34,33 +80,271 @@ std::string TSS::print()
     return s;
 }
 
+bool LinkedTSS::isEqual(const Solution& other) const
+{
+    const LinkedTSS* otherTSS = dynamic_cast<const LinkedTSS*>(&other);
+    if (!otherTSS || otherTSS->getSize() != getSize())
+        return false;
+
+    // the lists may start at different cities, compare them walking from city 0
+    int city = 0;
+    for (int k = 0; k < getSize(); k++)
+    {
+        int next = tour.next(city);
+        if (otherTSS->tour.next(city) != next)
+            return false;
+        city = next;
+    }
+    return true;
+}
+
+common::SolutionPtr LinkedTSS::clone() const
+{
+    return std::make_shared<LinkedTSS>(*this);
+}
+
+int LinkedTSS::getSize() const
+{
+    return this->tour.size();
+}
+
+std::uint64_t LinkedTSS::hash() const
+{
+    std::uint64_t hash = storedHash.get();
+    if (hash == 0)
+    {
+        // the edges walked from city 0, the same hash as the TSS of that tour
+        int city = 0;
+        for (int k = 0; k < getSize(); k++)
+        {
+            int next = tour.next(city);
+            hash ^= edgeKey(city, next);
+            city = next;
+        }
+        storedHash.set(hash);
+    }
+    return hash;
+}
+
+std::string LinkedTSS::print()
+{
+    std::string s;
+    for (int city: getTour())
+    {
+        s += std::to_string(city) + " ";
+    }
+    return s;
+}
+
+std::vector<int> LinkedTSS::getTour() const
+{
+    std::vector<int> cities;
+    tour.get(cities);
+    return cities;
+}
+
+void LinkedTSS::setTour(const std::vector<int>& cities)
+{
+    tour.set(cities);
+    storedHash.reset();
+}
+
 TSP::TSP(const Cities& cities)
 {
     this->cities = cities;
+    splitCoordinates();
 }
 
-float TSP::evaluateSolution(common::SolutionPtr sol)
+TSP::TSP(const Instance& instance)
+    : cities(instance.cities), edgeWeightType(instance.edgeWeightType), weights(instance.weights)
+{
+    splitCoordinates();
+}
+
+void TSP::splitCoordinates()
+{
+    xs.resize(cities.size());
+    ys.resize(cities.size());
+    for (int i = 0; i < (int) cities.size(); i++)
+    {
+        xs[i] = cities[i].x;
+        ys[i] = cities[i].y;
+    }
+}
+
+void TSP::setCities(const Cities& cities)
+{
+    this->cities = cities;
+    this->neighbors = NeighborLists();
+    splitCoordinates();
+    this->localSearch = nullptr;
+
+    if (evaluationCache)
+        evaluationCache->clear();
+
+    if (edgeWeightType == EdgeWeightType::EXPLICIT && weights.size() != cities.size() * cities.size())
+    {
+        edgeWeightType = EdgeWeightType::EUCLIDEAN;
+        weights.clear();
+    }
+
+    setInitialTour(initialTour);
+}
+
+void TSP::buildNeighborLists(int k, int quadrantK)
+{
+    neighbors = makeNeighborLists(k, quadrantK);
+
+    // the greedy tour only takes candidate edges
+    if (initialTour == InitialTour::GREEDY)
+        setInitialTour(initialTour);
+}
+
+NeighborLists TSP::makeNeighborLists(int k, int quadrantK) const
+{
+    // the k-d tree only orders by euclidean distance on x/y, which every
+    // coordinate metric but GEO preserves; the rest are sorted by brute force
+    if (edgeWeightType == EdgeWeightType::EXPLICIT || edgeWeightType == EdgeWeightType::GEO)
+    {
+        return NeighborLists(cities.size(), k, [this](int a, int b) {
+            return distance(a, b);
+        });
+    }
+
+    return NeighborLists(cities, k, quadrantK);
+}
+
+void TSP::setLocalSearch(bool enabled, int k)
+{
+    localSearch = enabled ? std::make_shared<LocalSearch>(*this, k) : nullptr;
+}
+
+void TSP::improveSolution(common::SolutionPtr sol)
 {
+    if (!localSearch)
+        return;
+
+    LinkedTSSPtr linked = std::dynamic_pointer_cast<LinkedTSS>(sol);
     TSSPtr tss = std::dynamic_pointer_cast<TSS>(sol);
-    float ev = 0;
+    if (linked)
+    {
+        localSearch->improve(linked->tour);
+        linked->storedHash.reset();
+    }
+    else
+    {
+        localSearch->improve(tss->tour);
+        tss->storedHash.reset();
+    }
+
+    sol->cost = evaluateSolution(sol);
+}
+
+float TSP::evaluateSolution(common::SolutionPtr sol)
+{
+    evaluations.fetch_add(1, std::memory_order_relaxed);
+
+    LinkedTSSPtr linked = std::dynamic_pointer_cast<LinkedTSS>(sol);
+    if (linked)
+    {
+        double ev = 0;
+        int city = 0;
+        for (int k = 0; k < linked->getSize(); k++)
+        {
+            int next = linked->tour.next(city);
+            ev += distance(city, next);
+            city = next;
+        }
+        return ev;
+    }
+
+    return evaluateTour(std::dynamic_pointer_cast<TSS>(sol)->tour.data());
+}
+
+float TSP::evaluateTour(const int* tour) const
+{
+    if (hasTourLengthKernel(edgeWeightType))
+        return tourLength(xs.data(), ys.data(), tour, cities.size(), edgeWeightType);
+
+    double ev = 0;
     int lastCityIndex = cities.size() - 1;
     for (int i = 0; i < lastCityIndex; i++)
     {
-        ev += cities[tss->tour[i]].distance(cities[tss->tour[i+1]]);
+        ev += distance(tour[i], tour[i+1]);
     }
-    ev += cities[tss->tour[lastCityIndex]].distance(cities[tss->tour[0]]);
+    ev += distance(tour[lastCityIndex], tour[0]);
     return ev;
 }
 
-common::SolutionPtr TSP::generateInitialSolution()
+std::vector<int> TSP::constructTour(InitialTour type) const
 {
+    int n = cities.size();
+    switch (type)
+    {
+        case InitialTour::NEAREST_NEIGHBOR:
+            return nearestNeighborTour(*this, n > 0 ? mhac_random::randint(0, n - 1) : 0);
+
+        case InitialTour::GREEDY:
+            return greedyTour(*this);
+
+        case InitialTour::SPACE_FILLING_CURVE:
+            return spaceFillingCurveTour(*this);
+
+        default:
+            return mhac_random::sample(n, n);
+    }
+}
+
+common::SolutionPtr TSP::constructSolution(InitialTour type) const
+{
+    return solutionOf(constructTour(type));
+}
+
+common::SolutionPtr TSP::solutionOf(std::vector<int> tour) const
+{
+    if (tourType == TourType::TWO_LEVEL_LIST)
+    {
+        LinkedTSSPtr linked = std::make_shared<LinkedTSS>();
+        linked->setTour(tour);
+        return linked;
+    }
+
     TSSPtr tss = std::make_shared<TSS>();
-    tss->tour = mhac_random::sample(cities.size(), cities.size());
+    tss->tour = std::move(tour);
     return tss;
 }
 
+void TSP::setInitialTour(InitialTour type)
+{
+    initialTour = type;
+    if (type == InitialTour::GREEDY || type == InitialTour::SPACE_FILLING_CURVE)
+        seedTour = constructTour(type);
+    else
+        seedTour.clear();
+}
+
+std::vector<int> TSP::seededTour() const
+{
+    bool seeded = initialTour != InitialTour::RANDOM && mhac_random::random() < seedRatio;
+    if (seeded && !seedTour.empty())
+        return seedTour;
+    return constructTour(seeded ? initialTour : InitialTour::RANDOM);
+}
+
+common::SolutionPtr TSP::generateInitialSolution()
+{
+    return solutionOf(seededTour());
+}
+
 common::SolutionPtr TSP::generateNewSolution(common::SolutionPtr initialSol)
 {
+    if (std::dynamic_pointer_cast<LinkedTSS>(initialSol))
+    {
+        common::SolutionPtr newSol = initialSol->clone();
+        applyMove(newSol, generateMove(newSol));
+        return newSol;
+    }
+
     TSSPtr tssInitial = std::dynamic_pointer_cast<TSS>(initialSol);
     TSSPtr tssNew = std::make_shared<TSS>();
     tssNew->tour = tssInitial->tour;
@@ -72,78 +356,270 @@ common::SolutionPtr TSP::generateNewSolution(common::SolutionPtr initialSol)
     if (i > j)
         std::swap(i, j);
 
+    // the new hash follows from the initial one, when that is known
+    std::uint64_t hash = tssInitial->storedHash.get();
+    if (hash != 0)
+        hash = hashAfterMove(tssInitial, hash, common::Move(i, j));
+
+    std::vector<int>& tour = tssNew->tour;
     for (int k = 0; k < (j-i+1) / 2; k++)
-        std::swap(tssNew->tour[i+k], tssNew->tour[j-k]);
+        std::swap(tour[i+k], tour[j-k]);
+    tssNew->storedHash.set(hash);
 
     return tssNew;
 }
 
-GA_TSP::GA_TSP(const Cities& cities): TSP(cities)
-{}
-
-void GA_TSP::repair(common::SolutionPtr sol)
+common::Move TSP::generateMove(common::SolutionPtr sol)
 {
-    TSSPtr tss = std::dynamic_pointer_cast<TSS>(sol);
-    std::unordered_set<int> seen;
-    std::vector<int> missing;
-
-    // identify all duplicates and records their positions
-    for (int i = 0; i < (int) tss->tour.size(); i++)
+    LinkedTSSPtr linked = std::dynamic_pointer_cast<LinkedTSS>(sol);
+    if (linked)
     {
-        if (seen.count(tss->tour[i])) {
-            missing.push_back(i);
+        int n = linked->getSize();
+        int a = mhac_random::randint(0, n - 1);
+        int b;
+        if (!neighbors.empty())
+        {
+            b = neighbors.begin(a)[mhac_random::randint(0, neighbors.size(a) - 1)];
         }
-        else {
-            seen.insert(tss->tour[i]);
+        else
+        {
+            b = mhac_random::randint(0, n - 2);
+            if (b >= a)
+                b++;
         }
+
+        // reversing the path after a up to b makes b follow a
+        return common::Move(linked->tour.next(a), b);
     }
 
-    // place them in the positions of duplicates
-    for (int city = 0; city < (int) cities.size(); city++)
+    if (!neighbors.empty())
     {
-        if (!seen.count(city)) {
-            tss->tour[missing.back()] = city;
-            missing.pop_back();
+        TSSPtr tss = std::dynamic_pointer_cast<TSS>(sol);
+        int n = tss->tour.size();
+
+        int i = mhac_random::randint(0, n - 1);
+        int a = tss->tour[i];
+        int b = neighbors.begin(a)[mhac_random::randint(0, neighbors.size(a) - 1)];
+
+        // positions are only maintained by applyMove, rebuild them if the
+        // tour was set or changed some other way
+        if ((int) tss->positions.size() != n || tss->positions[a] != i || tss->tour[tss->positions[b]] != b)
+        {
+            tss->positions.resize(n);
+            for (int k = 0; k < n; k++)
+                tss->positions[tss->tour[k]] = k;
         }
+
+        // reversing everything after a up to b makes b follow a
+        int j = tss->positions[b];
+        return common::Move(std::min(i, j) + 1, std::max(i, j));
     }
+
+    // two distinct positions without shuffling the whole index range
+    int n = sol->getSize();
+    common::Move move(mhac_random::randint(0, n - 1), mhac_random::randint(0, n - 2));
+    if (move.j >= move.i)
+        move.j++;
+
+    if (move.i > move.j)
+        std::swap(move.i, move.j);
+
+    return move;
 }
 
-common::SolutionVec GA_TSP::crossover(common::SolutionPtr parent1, common::SolutionPtr parent2)
+float TSP::evaluateMove(common::SolutionPtr sol, const common::Move& move)
 {
-    TSSPtr tss_parent1 = std::dynamic_pointer_cast<TSS>(parent1);
-    TSSPtr tss_parent2 = std::dynamic_pointer_cast<TSS>(parent2);
+    moveEvaluations.fetch_add(1, std::memory_order_relaxed);
+
+    LinkedTSSPtr linked = std::dynamic_pointer_cast<LinkedTSS>(sol);
+    if (linked)
+    {
+        int a = linked->tour.prev(move.i);
+        int b = move.i;
+        int c = move.j;
+        int d = linked->tour.next(move.j);
+        if (b == c || d == b)
+            return 0;
+
+        return distance(a, c) + distance(b, d) - distance(a, b) - distance(c, d);
+    }
 
-    globalLogger->debug("Parent1 (cost:" + std::to_string(tss_parent1->cost) + ")" + tss_parent1->print());
-    globalLogger->debug("Parent2 (cost:" + std::to_string(tss_parent2->cost) + ")" + tss_parent2->print());
+    TSSPtr tss = std::dynamic_pointer_cast<TSS>(sol);
+    int n = tss->tour.size();
 
-    TSSPtr outChild1 = std::make_shared<TSS>();
-    TSSPtr outChild2 = std::make_shared<TSS>();
+    // reversing the whole tour gives back the same cycle
+    if (move.j - move.i + 1 >= n)
+        return 0;
 
-    TSSPtr tss_outChild1 = std::dynamic_pointer_cast<TSS>(outChild1);
-    TSSPtr tss_outChild2 = std::dynamic_pointer_cast<TSS>(outChild2);
+    int a = tss->tour[(move.i - 1 + n) % n];
+    int b = tss->tour[move.i];
+    int c = tss->tour[move.j];
+    int d = tss->tour[(move.j + 1) % n];
 
-    int cutPoint = mhac_random::random(0, tss_parent1->tour.size() - 1);
+    // edges (a, b) and (c, d) are replaced by (a, c) and (b, d)
+    return distance(a, c) + distance(b, d) - distance(a, b) - distance(c, d);
+}
 
-    tss_outChild1->tour.resize(tss_parent1->tour.size());
-    tss_outChild2->tour.resize(tss_parent2->tour.size());
+void TSP::applyMove(common::SolutionPtr sol, const common::Move& move)
+{
+    LinkedTSSPtr linked = std::dynamic_pointer_cast<LinkedTSS>(sol);
+    if (linked)
+    {
+        std::uint64_t hash = linked->storedHash.get();
+        if (hash != 0)
+            linked->storedHash.set(hashAfterMove(sol, hash, move));
+        linked->tour.reverse(move.i, move.j);
+        return;
+    }
 
-    // [0, cutPoint)
-    std::copy(tss_parent1->tour.begin(), tss_parent1->tour.begin() + cutPoint, tss_outChild1->tour.begin());
-    std::copy(tss_parent2->tour.begin(), tss_parent2->tour.begin() + cutPoint, tss_outChild2->tour.begin());
+    TSSPtr tss = std::dynamic_pointer_cast<TSS>(sol);
+    std::uint64_t hash = tss->storedHash.get();
+    if (hash != 0)
+        tss->storedHash.set(hashAfterMove(sol, hash, move));
 
-    // [cutPoint, v.size())
-    std::copy(tss_parent2->tour.begin() + cutPoint, tss_parent2->tour.end(), tss_outChild1->tour.begin() + cutPoint);
-    std::copy(tss_parent1->tour.begin() + cutPoint, tss_parent1->tour.end(), tss_outChild2->tour.begin() + cutPoint);
+    int n = tss->tour.size();
+    int i = move.i;
+    int j = move.j;
+
+    // the tour is a cycle, so reversing the complementary segment gives the
+    // same tour; reverse whichever of the two is shorter
+    if (2 * (j - i + 1) > n)
+    {
+        std::swap(i, j);
+        i = i + 1;
+        j = j - 1 + n;
+    }
+
+    std::vector<int>& tour = tss->tour;
+    for (int k = 0; k < (j-i+1) / 2; k++)
+        std::swap(tour[(i+k) % n], tour[(j-k) % n]);
+
+    if ((int) tss->positions.size() == n)
+    {
+        for (int k = i; k <= j; k++)
+            tss->positions[tss->tour[k % n]] = k % n;
+    }
+}
+
+void TSP::undoMove(common::SolutionPtr sol, const common::Move& move)
+{
+    // the list keeps the direction of the rest of the tour, so the path
+    // now runs from j to i
+    LinkedTSSPtr linked = std::dynamic_pointer_cast<LinkedTSS>(sol);
+    if (linked)
+    {
+        common::Move back(move.j, move.i);
+        std::uint64_t hash = linked->storedHash.get();
+        if (hash != 0)
+            linked->storedHash.set(hashAfterMove(sol, hash, back));
+        linked->tour.reverse(back.i, back.j);
+        return;
+    }
+
+    // a reversal is its own inverse
+    applyMove(sol, move);
+}
+
+std::uint64_t TSP::hashAfterMove(common::SolutionPtr sol, std::uint64_t hash, const common::Move& move)
+{
+    // the edges evaluateMove swaps; a move giving back the same cycle,
+    // e.g. reversing the whole tour, keeps the hash
+    LinkedTSSPtr linked = std::dynamic_pointer_cast<LinkedTSS>(sol);
+    if (linked)
+    {
+        int a = linked->tour.prev(move.i);
+        int d = linked->tour.next(move.j);
+        if (move.i == move.j || d == move.i)
+            return hash;
+        return hashAfterTwoOpt(hash, a, move.i, move.j, d);
+    }
+
+    TSSPtr tss = std::dynamic_pointer_cast<TSS>(sol);
+    const std::vector<int>& tour = tss->tour;
+    int n = tour.size();
+    if (move.j - move.i + 1 >= n)
+        return hash;
+
+    return hashAfterTwoOpt(hash, tour[(move.i - 1 + n) % n], tour[move.i], tour[move.j], tour[(move.j + 1) % n]);
+}
+
+std::uint64_t TSP::moveAttribute(common::SolutionPtr sol, const common::Move& move)
+{
+    // a LinkedTSS move already names the two cities
+    int a = move.i;
+    int b = move.j;
+
+    TSSPtr tss = std::dynamic_pointer_cast<TSS>(sol);
+    if (tss)
+    {
+        a = tss->tour[move.i];
+        b = tss->tour[move.j];
+    }
+
+    if (a > b)
+        std::swap(a, b);
+    return (std::uint64_t) (unsigned) a << 32 | (unsigned) b;
+}
+
+GA_TSP::GA_TSP(const Cities& cities): TSP(cities)
+{}
+
+GA_TSP::GA_TSP(const Instance& instance): TSP(instance)
+{}
+
+void GA_TSP::repair(common::SolutionPtr sol)
+{
+    TSSPtr tss = std::dynamic_pointer_cast<TSS>(sol);
+    evolutionary::GA::repairPermutation(tss->tour);
+}
+
+void GA_TSP::setEdgeAssembly(bool enabled, int trials, int k)
+{
+    edgeAssembly = enabled ? std::make_shared<EdgeAssembly>(*this, trials, k) : nullptr;
+
+    if (enabled)
+        crossoverType = evolutionary::GA::CrossoverType::EDGE_ASSEMBLY;
+    else if (crossoverType == evolutionary::GA::CrossoverType::EDGE_ASSEMBLY)
+        crossoverType = evolutionary::GA::CrossoverType::ONE_POINT;
+}
+
+common::SolutionVec GA_TSP::crossover(common::SolutionPtr parent1, common::SolutionPtr parent2)
+{
+    TSSPtr tss_parent1 = std::dynamic_pointer_cast<TSS>(parent1);
+    TSSPtr tss_parent2 = std::dynamic_pointer_cast<TSS>(parent2);
+
+    // the messages are only built when they are going to be logged
+    bool debug = globalLogger->should_log(spdlog::level::debug);
+    if (debug)
+    {
+        globalLogger->debug("Parent1 (cost:" + std::to_string(tss_parent1->cost) + ")" + tss_parent1->print());
+        globalLogger->debug("Parent2 (cost:" + std::to_string(tss_parent2->cost) + ")" + tss_parent2->print());
+    }
+
+    TSSPtr tss_outChild1 = std::make_shared<TSS>();
+    TSSPtr tss_outChild2 = std::make_shared<TSS>();
+
+    if (crossoverType == evolutionary::GA::CrossoverType::EDGE_ASSEMBLY)
+    {
+        if (!edgeAssembly)
+            throw std::logic_error("the EDGE_ASSEMBLY crossover needs setEdgeAssembly(true) first");
+
+        edgeAssembly->cross(tss_parent1->tour, tss_parent2->tour, tss_outChild1->tour);
+        edgeAssembly->cross(tss_parent2->tour, tss_parent1->tour, tss_outChild2->tour);
+    }
+    else
+    {
+        evolutionary::GA::permutationCrossover(crossoverType, tss_parent1->tour, tss_parent2->tour, tss_outChild1->tour, tss_outChild2->tour);
+    }
 
-    // repair
-    repair(outChild1);
-    repair(outChild2);
-    
     tss_outChild1->cost = evaluateSolution(tss_outChild1);
     tss_outChild2->cost = evaluateSolution(tss_outChild2);
 
-    globalLogger->debug("Child1 (cost:" + std::to_string(tss_outChild1->cost) + ")" + tss_outChild1->print());
-    globalLogger->debug("Child2 (cost:" + std::to_string(tss_outChild2->cost) + ")" + tss_outChild2->print());
+    if (debug)
+    {
+        globalLogger->debug("Child1 (cost:" + std::to_string(tss_outChild1->cost) + ")" + tss_outChild1->print());
+        globalLogger->debug("Child2 (cost:" + std::to_string(tss_outChild2->cost) + ")" + tss_outChild2->print());
+    }
 
     common::SolutionVec res {tss_outChild1, tss_outChild2};
     return res;
@@ -159,88 +635,251 @@ common::SolutionPtr GA_TSP::mutation(common::SolutionPtr outChild, float mutatio
     if (mhac_random::random() < mutationChance)
     {
         std::swap(tss->tour[i], tss->tour[j]);
+        tss->storedHash.reset();
         tss->cost = evaluateSolution(tss);
 
-        globalLogger->debug("Mutation (cost:" + std::to_string(tss->cost) + ")" + tss->print());
+        if (globalLogger->should_log(spdlog::level::debug))
+            globalLogger->debug("Mutation (cost:" + std::to_string(tss->cost) + ")" + tss->print());
+    }
+
+    return tss;
+}
+
+void GA_TSP::initialGenome(int* genome)
+{
+    std::vector<int> tour = seededTour();
+    std::copy(tour.begin(), tour.end(), genome);
+}
+
+void GA_TSP::crossoverGenomes(const int* parent1, const int* parent2, int* child1, int* child2)
+{
+    int n = cities.size();
+    if (crossoverType == evolutionary::GA::CrossoverType::EDGE_ASSEMBLY)
+    {
+        if (!edgeAssembly)
+            throw std::logic_error("the EDGE_ASSEMBLY crossover needs setEdgeAssembly(true) first");
+
+        edgeAssembly->cross(parent1, parent2, child1, n);
+        edgeAssembly->cross(parent2, parent1, child2, n);
+        return;
     }
 
+    evolutionary::GA::permutationCrossover(crossoverType, parent1, parent2, child1, child2, n);
+}
+
+void GA_TSP::mutateGenome(int* genome, float mutationChance)
+{
+    int n = cities.size();
+    if (n < 2 || mhac_random::random() >= mutationChance)
+        return;
+
+    // two different positions
+    int i = mhac_random::randint(0, n - 1);
+    int j = mhac_random::randint(0, n - 2);
+    if (j >= i)
+        j++;
+    std::swap(genome[i], genome[j]);
+}
+
+void GA_TSP::improveGenome(int* genome)
+{
+    if (!localSearch)
+        return;
+
+    // the local search works on a vector, the one of the thread is reused
+    thread_local std::vector<int> tour;
+    tour.assign(genome, genome + cities.size());
+    localSearch->improve(tour);
+    std::copy(tour.begin(), tour.end(), genome);
+}
+
+float GA_TSP::evaluateGenome(const int* genome)
+{
+    evaluations.fetch_add(1, std::memory_order_relaxed);
+    return evaluateTour(genome);
+}
+
+std::uint64_t GA_TSP::hashGenome(const int* genome)
+{
+    return hashTour(genome, cities.size());
+}
+
+common::SolutionPtr GA_TSP::genomeSolution(const int* genome)
+{
+    TSSPtr tss = std::make_shared<TSS>();
+    tss->tour.assign(genome, genome + cities.size());
     return tss;
 }
 
 ACO_TSP::ACO_TSP(const Cities& cities): TSP(cities)
 {}
 
-common::SolutionPtr ACO_TSP::updateAntPath(common::SolutionPtr ant, swarm::ACO::PheromoneMatrixPtr pm, float alpha, float beta)
+ACO_TSP::ACO_TSP(const Instance& instance): TSP(instance)
+{}
+
+float ACO_TSP::heuristic(int i, int j) const
 {
-    TSSPtr tss_ant = std::dynamic_pointer_cast<TSS>(ant);
-    // globalLogger->debug("Starting tour: " + tss_ant->print());
+    float dist = distance(i, j);
+    return dist == 0 ? 0 : 1 / dist;
+}
 
-    tss_ant->tour[0] = 0;
+namespace
+{
 
-    std::vector<int> availableCitiesIndexes;
-    for (int i = 1; i < (int) cities.size(); i++) {
-        availableCitiesIndexes.push_back(i);
-    }
+// what building a tour needs besides the tour itself, kept per thread so
+// an ant allocates nothing once its thread has built a tour of that size
+struct AntScratch
+{
+    std::vector<int> unvisited;     // the cities left, in no particular order
+    std::vector<int> slot;          // index of every city in unvisited, -1 once visited
+    std::vector<int> candidates;    // the unvisited candidates of the current city
+    std::vector<double> cumulative; // prefix sums of their weights
 
-    // remove starting city in tour
-    // availableCitiesIndexes.erase(availableCitiesIndexes.begin() + tss_ant->tour[0]);
+    void reset(int n)
+    {
+        unvisited.resize(n);
+        slot.resize(n);
+        for (int city = 0; city < n; city++) {
+            unvisited[city] = city;
+            slot[city] = city;
+        }
+    }
 
-    for (int node = 1; node < (int) tss_ant->getSize(); node++) {
-        std::vector<float> probabilities(tss_ant->getSize(), 0);
+    bool visited(int city) const { return slot[city] < 0; }
 
-        float sum = 0;
+    // O(1): the last unvisited city takes the place of the removed one
+    void visit(int city)
+    {
+        int last = unvisited.back();
+        unvisited[slot[city]] = last;
+        slot[last] = slot[city];
+        unvisited.pop_back();
+        slot[city] = -1;
+    }
 
-        for (const int cindex: availableCitiesIndexes) {
-            float distance = cities[tss_ant->tour[node-1]].distance(cities[cindex]);
-            if (distance == 0) {
-                continue; // Optionally handle this case more gracefully
-            }
-            float eta = 1 / distance;
-            float t = std::pow((*pm)(tss_ant->tour[node-1], cindex), alpha)  * std::pow(eta, beta);
-            sum += t;
-            probabilities[cindex] = t;
+    // roulette over the first count prefix sums, -1 when they are all 0
+    int spin(int count) const
+    {
+        double sum = cumulative[count - 1];
+        if (!(sum > 0)) {
+            return -1;
         }
 
-        for (const int cindex: availableCitiesIndexes) {
-            probabilities[cindex] /= sum;
+        double u = mhac_random::random() * sum;
+        int k = std::upper_bound(cumulative.begin(), cumulative.begin() + count, u) - cumulative.begin();
+        return std::min(k, count - 1);
+    }
+};
+
+AntScratch& antScratch()
+{
+    thread_local AntScratch scratch;
+    return scratch;
+}
+
+} // namespace
+
+common::SolutionPtr ACO_TSP::updateAntPath(common::SolutionPtr ant, swarm::ACO::PheromoneMatrixPtr pm, float alpha, float beta)
+{
+    TSSPtr tss_ant = std::dynamic_pointer_cast<TSS>(ant);
+
+    // tau^alpha * eta^beta, looked up in the solver's cache when it was built
+    // for these arguments; 0 for cities at the same place either way
+    const swarm::ACO::ChoiceInfo* info = choiceInfo && choiceInfo->matches(*pm, alpha, beta) ? choiceInfo.get() : nullptr;
+    const swarm::ACO::PheromoneMatrix& tau = *pm;
+    auto weight = [this, info, &tau, alpha, beta](int i, int j) -> float {
+        if (info) {
+            return (*info)(i, j);
         }
+        float eta = heuristic(i, j);
+        return eta == 0 ? 0 : std::pow(tau(i, j), alpha) * std::pow(eta, beta);
+    };
+
+    int n = tss_ant->getSize();
+    AntScratch& scratch = antScratch();
+    scratch.reset(n);
+    if ((int) scratch.cumulative.size() < n) {
+        scratch.cumulative.resize(n);
+    }
+
+    tss_ant->tour[0] = 0;
+    scratch.visit(0);
+
+    for (int node = 1; node < n; node++) {
+        int current = tss_ant->tour[node-1];
+        int next = -1;
 
-        // select the node
-        int probIndex = 0;
-        float s = probabilities[0];
-        float u = mhac_random::random();
+        // with neighbor lists, choose among the unvisited candidates of the
+        // current city and only score every unvisited city when none is left
+        if (!neighbors.empty()) {
+            scratch.candidates.clear();
+            double sum = 0;
 
-        while (u > s) {
-            probIndex++;
-            s += probabilities[probIndex]; 
+            for (const int* it = neighbors.begin(current); it != neighbors.end(current); ++it) {
+                if (scratch.visited(*it)) {
+                    continue;
+                }
+                sum += weight(current, *it);
+                scratch.cumulative[scratch.candidates.size()] = sum;
+                scratch.candidates.push_back(*it);
+            }
+
+            if (!scratch.candidates.empty()) {
+                int k = scratch.spin(scratch.candidates.size());
+                next = k < 0 ? -1 : scratch.candidates[k];
+            }
         }
 
-        // globalLogger->debug("Next city in tour: " + std::to_string(probIndex));
+        if (next < 0) {
+            int count = scratch.unvisited.size();
+            double sum = 0;
 
-        availableCitiesIndexes.erase(std::find(availableCitiesIndexes.begin(), availableCitiesIndexes.end(), probIndex));
+            for (int k = 0; k < count; k++) {
+                sum += weight(current, scratch.unvisited[k]);
+                scratch.cumulative[k] = sum;
+            }
 
-        tss_ant->tour[node] = probIndex;
+            // all the cities left are at the same place as the current one
+            int k = scratch.spin(count);
+            next = scratch.unvisited[k < 0 ? mhac_random::randint(0, count - 1) : k];
+        }
+
+        tss_ant->tour[node] = next;
+        scratch.visit(next);
     }
+    tss_ant->storedHash.reset();
 
-    // globalLogger->debug("Computed tour: " + tss_ant->print());
     return tss_ant;
 }
 
+bool ACO_TSP::candidateLists(std::vector<int>& offsets, std::vector<int>& candidates) const
+{
+    if (neighbors.empty())
+        return false;
+
+    offsets.assign(1, 0);
+    candidates.clear();
+    for (int city = 0; city < (int) cities.size(); city++) {
+        candidates.insert(candidates.end(), neighbors.begin(city), neighbors.end(city));
+        offsets.push_back(candidates.size());
+    }
+    return true;
+}
+
 void ACO_TSP::updatePheromoneMatrix(common::SolutionPtr ant, swarm::ACO::PheromoneMatrixPtr pm, float rho)
 {
-    TSSPtr tss_ant = std::dynamic_pointer_cast<TSS>(ant);
-    for (int i = 0; i < pm->getSize(); i++) {
-        for (int j = 0; j < pm->getSize(); j++) {
-            float pheromoneDeposit = 0;
+    pm->scale(1 - rho);
+    depositPheromone(ant, *pm, rho);
+}
 
-            for (int k = 1; k < pm->getSize()-1; k++) {
-                if (tss_ant->tour[k] == i && tss_ant->tour[k+1] == j) {
-                    pheromoneDeposit = 1 / (cities[i].distance(cities[j]));
-                }
-            }
+void ACO_TSP::depositPheromone(common::SolutionPtr ant, swarm::ACO::PheromoneMatrix& pm, float weight)
+{
+    TSSPtr tss_ant = std::dynamic_pointer_cast<TSS>(ant);
+    const std::vector<int>& tour = tss_ant->tour;
+    float amount = weight / ant->cost;
 
-            (*pm)(i, j) = (1-rho) * (*pm)(i, j) + rho*pheromoneDeposit;
-        }
+    for (int k = 0; k < (int) tour.size(); k++) {
+        pm.add(tour[k], tour[k + 1 == (int) tour.size() ? 0 : k + 1], amount);
     }
 }
 
@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "problems/TSP.hpp"
+#include "problems/TSPConstruction.hpp"
+
+namespace problems
+{
+namespace tsp
+{
+
+namespace
+{
+
+bool hasSpatialOrder(const TSP& problem)
+{
+    return problem.edgeWeightType != EdgeWeightType::EXPLICIT && problem.edgeWeightType != EdgeWeightType::GEO;
+}
+
+// closest city to city among the ones with available set, -1 if none
+int nearestByScan(const TSP& problem, int city, const std::vector<char>& available)
+{
+    int best = -1;
+    float bestDist = 0;
+    for (int other = 0; other < (int) available.size(); other++)
+    {
+        if (other == city || !available[other])
+            continue;
+
+        float dist = problem.distance(city, other);
+        if (best < 0 || dist < bestDist)
+        {
+            best = other;
+            bestDist = dist;
+        }
+    }
+    return best;
+}
+
+int findRoot(std::vector<int>& parent, int city)
+{
+    while (parent[city] != city)
+    {
+        parent[city] = parent[parent[city]];
+        city = parent[city];
+    }
+    return city;
+}
+
+// position of (x, y) along a Hilbert curve filling a side x side grid
+uint64_t hilbertIndex(uint32_t side, uint32_t x, uint32_t y)
+{
+    uint64_t d = 0;
+    for (uint32_t s = side / 2; s > 0; s /= 2)
+    {
+        uint32_t rx = (x & s) > 0;
+        uint32_t ry = (y & s) > 0;
+        d += (uint64_t) s * s * ((3 * rx) ^ ry);
+
+        if (ry == 0)
+        {
+            if (rx == 1)
+            {
+                x = side - 1 - x;
+                y = side - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+} // namespace
+
+std::vector<int> nearestNeighborTour(const TSP& problem, int start)
+{
+    int n = problem.cities.size();
+    std::vector<int> tour;
+    tour.reserve(n);
+    if (n == 0)
+        return tour;
+
+    int city = start;
+    tour.push_back(city);
+
+    if (hasSpatialOrder(problem))
+    {
+        KDTree tree(problem.cities);
+        tree.remove(city);
+        for (int k = 1; k < n; k++)
+        {
+            city = tree.nearestRemaining(city);
+            tree.remove(city);
+            tour.push_back(city);
+        }
+        return tour;
+    }
+
+    std::vector<char> available(n, 1);
+    available[city] = 0;
+    for (int k = 1; k < n; k++)
+    {
+        city = nearestByScan(problem, city, available);
+        available[city] = 0;
+        tour.push_back(city);
+    }
+    return tour;
+}
+
+std::vector<int> greedyTour(const TSP& problem)
+{
+    int n = problem.cities.size();
+    if (n < 3)
+        return nearestNeighborTour(problem, 0);
+
+    NeighborLists ownLists;
+    if (problem.neighbors.empty())
+        ownLists = problem.makeNeighborLists(10);
+    const NeighborLists& lists = problem.neighbors.empty() ? ownLists : problem.neighbors;
+
+    struct Edge
+    {
+        float length;
+        int a;
+        int b;
+        bool operator<(const Edge& e) const
+        {
+            return length < e.length || (length == e.length && (a < e.a || (a == e.a && b < e.b)));
+        }
+    };
+
+    std::vector<Edge> edges;
+    for (int a = 0; a < n; a++)
+    {
+        for (const int* it = lists.begin(a); it != lists.end(a); ++it)
+            edges.push_back({problem.distance(a, *it), std::min(a, *it), std::max(a, *it)});
+    }
+    std::sort(edges.begin(), edges.end());
+
+    // the chosen edges form paths, adjacent holds both ends of every city's edges
+    std::vector<int> adjacent(2 * n, -1);
+    std::vector<int> degree(n, 0);
+    std::vector<int> parent(n);
+    std::iota(parent.begin(), parent.end(), 0);
+
+    for (const Edge& e: edges)
+    {
+        if (degree[e.a] == 2 || degree[e.b] == 2)
+            continue;
+
+        int rootA = findRoot(parent, e.a);
+        int rootB = findRoot(parent, e.b);
+        if (rootA == rootB)
+            continue;
+
+        parent[rootA] = rootB;
+        adjacent[2 * e.a + degree[e.a]++] = e.b;
+        adjacent[2 * e.b + degree[e.b]++] = e.a;
+    }
+
+    // walk every path end to end, then jump to the closest free endpoint;
+    // interior cities are never candidates for the jump
+    bool spatial = hasSpatialOrder(problem);
+    KDTree tree(spatial ? problem.cities : Cities());
+    std::vector<char> available(n, 0);
+    int city = -1;
+    for (int c = 0; c < n; c++)
+    {
+        if (degree[c] < 2)
+        {
+            available[c] = 1;
+            if (city < 0)
+                city = c;
+        }
+        else if (spatial)
+        {
+            tree.remove(c);
+        }
+    }
+
+    std::vector<int> tour;
+    tour.reserve(n);
+
+    while (city >= 0)
+    {
+        int previous = -1;
+        int current = city;
+        while (true)
+        {
+            tour.push_back(current);
+            int next = adjacent[2 * current] != previous ? adjacent[2 * current] : adjacent[2 * current + 1];
+            if (next < 0)
+                break;
+            previous = current;
+            current = next;
+        }
+
+        for (int end: {city, current})
+        {
+            available[end] = 0;
+            if (spatial)
+                tree.remove(end);
+        }
+
+        city = spatial ? tree.nearestRemaining(current) : nearestByScan(problem, current, available);
+    }
+
+    return tour;
+}
+
+std::vector<int> spaceFillingCurveTour(const TSP& problem)
+{
+    const Cities& cities = problem.cities;
+    int n = cities.size();
+    std::vector<int> tour(n);
+    std::iota(tour.begin(), tour.end(), 0);
+    if (n == 0)
+        return tour;
+
+    double minX = cities[0].x, maxX = minX;
+    double minY = cities[0].y, maxY = minY;
+    for (const City& c: cities)
+    {
+        minX = std::min(minX, c.x);
+        maxX = std::max(maxX, c.x);
+        minY = std::min(minY, c.y);
+        maxY = std::max(maxY, c.y);
+    }
+
+    // one scale on both axes so the curve follows the real distances
+    const uint32_t side = 1u << 16;
+    double span = std::max(maxX - minX, maxY - minY);
+    double scale = span > 0 ? (side - 1) / span : 0;
+
+    std::vector<uint64_t> keys(n);
+    for (int i = 0; i < n; i++)
+    {
+        uint32_t x = (uint32_t) ((cities[i].x - minX) * scale);
+        uint32_t y = (uint32_t) ((cities[i].y - minY) * scale);
+        keys[i] = hilbertIndex(side, x, y);
+    }
+
+    std::sort(tour.begin(), tour.end(), [&keys](int a, int b) {
+        return keys[a] < keys[b];
+    });
+    return tour;
+}
+
+} // namespace tsp
+} // namespace problems
@@ -0,0 +1,485 @@
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "random/random.hpp"
+
+#include "problems/TSP.hpp"
+#include "problems/TSPEdgeAssembly.hpp"
+
+namespace problems
+{
+namespace tsp
+{
+
+namespace
+{
+
+// 2-exchange merging two sub-tours: edges (c, c2) and (d, d2) are replaced
+// by (c, d) and (c2, d2), or by (c, d2) and (c2, d) when crossed
+struct Exchange
+{
+    int c, c2, d, d2;
+    bool crossed;
+};
+
+struct Scratch
+{
+    int n = 0;
+    std::vector<int> tour;          // parent1
+    std::vector<int> position;      // of every city in parent1
+
+    // the two neighbours of every city: in the solution being built, and
+    // the edges of each parent not in the other one, -1 once used
+    std::vector<int> link;
+    std::vector<int> linkB;
+    std::vector<int> restA;
+    std::vector<int> restB;
+
+    // AB-cycle search: the alternating path and where each city sits in it,
+    // at an even and at an odd index
+    std::vector<int> path;
+    std::vector<int> atEven;
+    std::vector<int> atOdd;
+    std::vector<int> cycles;        // cities of every AB-cycle, an A edge first
+    std::vector<int> cycleOffsets;
+    std::vector<int> order;
+
+    // one trial: writes to link to undo, the cuts of parent1, its segments
+    // and the sub-tours they form
+    std::vector<std::pair<int, int>> undo;
+    std::vector<int> cuts;
+    std::vector<int> segmentComponent;
+    std::vector<int> segmentNext;
+    std::vector<int> partners;      // the B edges at every segment end, 2 per city
+    std::vector<int> touched;
+    std::vector<int> componentParent;
+    std::vector<int> componentSize;
+    std::vector<int> componentHead;
+    std::vector<int> componentTail;
+    std::vector<Exchange> exchanges;
+    std::vector<Exchange> bestExchanges;
+
+    void reset(int cities)
+    {
+        n = cities;
+        position.resize(n);
+        link.resize(2 * n);
+        linkB.resize(2 * n);
+        restA.resize(2 * n);
+        restB.resize(2 * n);
+        atEven.assign(n, -1);
+        atOdd.assign(n, -1);
+        partners.assign(2 * n, -1);
+        path.clear();
+        cycles.clear();
+        cycleOffsets.assign(1, 0);
+    }
+
+    int cycleCount() const { return cycleOffsets.size() - 1; }
+
+    // O(1) edits of the solution being built, logged to be undone
+    void write(int slot, int value)
+    {
+        undo.push_back(std::make_pair(slot, link[slot]));
+        link[slot] = value;
+    }
+
+    void unlink(int a, int b)
+    {
+        write(link[2 * a] == b ? 2 * a : 2 * a + 1, -1);
+        write(link[2 * b] == a ? 2 * b : 2 * b + 1, -1);
+    }
+
+    void connect(int a, int b)
+    {
+        write(link[2 * a] == -1 ? 2 * a : 2 * a + 1, b);
+        write(link[2 * b] == -1 ? 2 * b : 2 * b + 1, a);
+    }
+
+    void rollback()
+    {
+        for (size_t k = undo.size(); k-- > 0;)
+            link[undo[k].first] = undo[k].second;
+        undo.clear();
+    }
+
+    // index of the segment holding city: the last cut before it, the
+    // segment wrapping around the end of parent1 when there is none
+    int segmentOf(int city) const
+    {
+        int j = std::lower_bound(cuts.begin(), cuts.end(), position[city]) - cuts.begin() - 1;
+        return j < 0 ? cuts.size() - 1 : j;
+    }
+
+    int segmentStart(int j) const { return tour[(cuts[j] + 1) % n]; }
+    int segmentEnd(int j) const { return tour[cuts[(j + 1) % cuts.size()]]; }
+    int segmentSize(int j) const
+    {
+        int size = (cuts[(j + 1) % cuts.size()] - cuts[j] + n) % n;
+        return size == 0 ? n : size;
+    }
+
+    int find(int component)
+    {
+        while (componentParent[component] != component)
+        {
+            componentParent[component] = componentParent[componentParent[component]];
+            component = componentParent[component];
+        }
+        return component;
+    }
+
+    int componentOf(int city) { return find(segmentComponent[segmentOf(city)]); }
+};
+
+Scratch& scratch()
+{
+    thread_local Scratch s;
+    return s;
+}
+
+// takes one of the remaining edges at city, at random when there are two,
+// out of both of its ends; -1 when none is left
+int takeEdge(std::vector<int>& rest, int city)
+{
+    int first = rest[2 * city], second = rest[2 * city + 1];
+    if (first < 0 && second < 0)
+        return -1;
+
+    int slot = first < 0 ? 1 : second < 0 ? 0 : mhac_random::randint(0, 1);
+    int other = rest[2 * city + slot];
+    rest[2 * city + slot] = -1;
+    rest[rest[2 * other] == city ? 2 * other : 2 * other + 1] = -1;
+    return other;
+}
+
+bool hasEdge(const std::vector<int>& link, int a, int b)
+{
+    return link[2 * a] == b || link[2 * a + 1] == b;
+}
+
+// every AB-cycle of the edges left in s.restA and s.restB: an alternating
+// walk is extended until it comes back to a city at an index of the same
+// parity, then the closed part is cut off as a cycle
+void buildCycles(Scratch& s)
+{
+    int n = s.n;
+    int offset = mhac_random::randint(0, n - 1);
+
+    for (int k = 0; k < n; k++)
+    {
+        int start = (offset + k) % n;
+        if (s.restA[2 * start] < 0 && s.restA[2 * start + 1] < 0)
+            continue;
+
+        s.path.assign(1, start);
+        s.atEven[start] = 0;
+
+        while (true)
+        {
+            int last = s.path.size() - 1;
+            int next = takeEdge(last % 2 == 0 ? s.restA : s.restB, s.path[last]);
+            if (next < 0)
+                break;
+
+            int index = last + 1;
+            s.path.push_back(next);
+            std::vector<int>& at = index % 2 == 0 ? s.atEven : s.atOdd;
+
+            if (at[next] < 0)
+            {
+                at[next] = index;
+                continue;
+            }
+
+            // path[from..index] is closed, from's outgoing edge alternates with
+            // the one coming in; stored starting on an A edge
+            int from = at[next];
+            int shift = from % 2;
+            for (int i = 0; i < index - from; i++)
+                s.cycles.push_back(s.path[from + (i + shift) % (index - from)]);
+            s.cycleOffsets.push_back(s.cycles.size());
+
+            for (int i = from + 1; i < index; i++)
+                (i % 2 == 0 ? s.atEven : s.atOdd)[s.path[i]] = -1;
+            s.path.resize(from + 1);
+        }
+
+        // only the start is left once all the cycles through it are closed
+        for (int i = 0; i < (int) s.path.size(); i++)
+            (i % 2 == 0 ? s.atEven : s.atOdd)[s.path[i]] = -1;
+        s.path.clear();
+    }
+}
+
+} // namespace
+
+EdgeAssembly::EdgeAssembly(const TSP& problem, int trials, int k)
+    : mProblem(problem),
+      mNeighbors(problem.neighbors.empty() ? problem.makeNeighborLists(k) : problem.neighbors),
+      mTrials(trials)
+{
+    if (trials < 1)
+        throw std::invalid_argument("EdgeAssembly needs at least 1 trial");
+}
+
+double EdgeAssembly::cross(const std::vector<int>& parent1, const std::vector<int>& parent2, std::vector<int>& child) const
+{
+    if (parent2.size() != parent1.size())
+        throw std::invalid_argument("EdgeAssembly::cross expects two tours of the problem's cities");
+
+    child.resize(parent1.size());
+    return cross(parent1.data(), parent2.data(), child.data(), parent1.size());
+}
+
+double EdgeAssembly::cross(const int* parent1, const int* parent2, int* child, int n) const
+{
+    if (n != (int) mProblem.cities.size())
+        throw std::invalid_argument("EdgeAssembly::cross expects two tours of the problem's cities");
+
+    std::copy(parent1, parent1 + n, child);
+    if (n < 5)
+        return 0;
+
+    Scratch& s = scratch();
+    s.reset(n);
+    s.tour.assign(parent1, parent1 + n);
+
+    std::vector<int>& linkB = s.linkB;
+    for (int i = 0; i < n; i++)
+    {
+        s.position[parent1[i]] = i;
+        s.link[2 * parent1[i]] = parent1[(i + n - 1) % n];
+        s.link[2 * parent1[i] + 1] = parent1[(i + 1) % n];
+        linkB[2 * parent2[i]] = parent2[(i + n - 1) % n];
+        linkB[2 * parent2[i] + 1] = parent2[(i + 1) % n];
+    }
+
+    // shared edges can't be part of an AB-cycle
+    for (int slot = 0; slot < 2 * n; slot++)
+    {
+        int city = slot / 2;
+        s.restA[slot] = hasEdge(linkB, city, s.link[slot]) ? -1 : s.link[slot];
+        s.restB[slot] = hasEdge(s.link, city, linkB[slot]) ? -1 : linkB[slot];
+    }
+
+    buildCycles(s);
+    if (s.cycleCount() == 0)
+        return 0;
+
+    // the AB-cycles tried, in random order
+    s.order.resize(s.cycleCount());
+    for (int c = 0; c < s.cycleCount(); c++)
+        s.order[c] = c;
+    int trials = std::min(mTrials, s.cycleCount());
+    for (int t = 0; t < trials; t++)
+        std::swap(s.order[t], s.order[mhac_random::randint(t, s.cycleCount() - 1)]);
+
+    double bestGain = std::numeric_limits<double>::max();
+    int bestCycle = -1;
+
+    for (int t = 0; t < trials; t++)
+    {
+        const int* cycle = s.cycles.data() + s.cycleOffsets[s.order[t]];
+        int length = s.cycleOffsets[s.order[t] + 1] - s.cycleOffsets[s.order[t]];
+        double gain = 0;
+
+        // swap the A edges (cycle[2i], cycle[2i + 1]) for the B edges
+        // (cycle[2i + 1], cycle[2i + 2]), cutting parent1 at every A edge
+        s.cuts.clear();
+        for (int i = 0; i < length; i += 2)
+        {
+            int a = cycle[i], b = cycle[i + 1];
+            gain -= mProblem.distance(a, b);
+            s.unlink(a, b);
+            s.cuts.push_back((s.position[a] + 1) % n == s.position[b] ? s.position[a] : s.position[b]);
+        }
+        for (int i = 1; i < length; i += 2)
+        {
+            int a = cycle[i], b = cycle[(i + 1) % length];
+            gain += mProblem.distance(a, b);
+            s.connect(a, b);
+
+            s.partners[s.partners[2 * a] < 0 ? 2 * a : 2 * a + 1] = b;
+            s.partners[s.partners[2 * b] < 0 ? 2 * b : 2 * b + 1] = a;
+            s.touched.push_back(a);
+            s.touched.push_back(b);
+        }
+        std::sort(s.cuts.begin(), s.cuts.end());
+
+        // sub-tours, as chains of segments joined by the B edges
+        int segments = s.cuts.size();
+        s.segmentComponent.assign(segments, -1);
+        s.segmentNext.assign(segments, -1);
+        s.componentParent.clear();
+        s.componentSize.clear();
+        s.componentHead.clear();
+        s.componentTail.clear();
+
+        for (int first = 0; first < segments; first++)
+        {
+            if (s.segmentComponent[first] >= 0)
+                continue;
+
+            int component = s.componentParent.size();
+            s.componentParent.push_back(component);
+            s.componentSize.push_back(0);
+            s.componentHead.push_back(first);
+            s.componentTail.push_back(first);
+
+            int segment = first, entry = s.segmentStart(first), from = -1;
+            for (int steps = 0; steps < segments; steps++)
+            {
+                s.segmentComponent[segment] = component;
+                s.componentSize[component] += s.segmentSize(segment);
+
+                // leave by the other end along its B edge; a segment of one
+                // city has two, the one not just taken
+                int exit = entry == s.segmentStart(segment) ? s.segmentEnd(segment) : s.segmentStart(segment);
+                int to = s.partners[2 * exit];
+                if (s.segmentStart(segment) == s.segmentEnd(segment) && to == from)
+                    to = s.partners[2 * exit + 1];
+
+                int next = s.segmentOf(to);
+                if (next == first)
+                    break;
+
+                s.segmentNext[s.componentTail[component]] = next;
+                s.componentTail[component] = next;
+                segment = next;
+                entry = to;
+                from = exit;
+            }
+        }
+
+        // merge the smallest sub-tour into another until one tour is left
+        s.exchanges.clear();
+        for (int left = s.componentParent.size(); left > 1; left--)
+        {
+            int smallest = -1;
+            for (int c = 0; c < (int) s.componentParent.size(); c++)
+            {
+                if (s.componentParent[c] == c && (smallest < 0 || s.componentSize[c] < s.componentSize[smallest]))
+                    smallest = c;
+            }
+
+            Exchange best = {-1, -1, -1, -1, false};
+            double bestDelta = std::numeric_limits<double>::max();
+
+            auto consider = [&](int c, int d) {
+                for (int i = 0; i < 2; i++)
+                {
+                    int c2 = s.link[2 * c + i];
+                    double dcc2 = mProblem.distance(c, c2);
+                    for (int j = 0; j < 2; j++)
+                    {
+                        int d2 = s.link[2 * d + j];
+                        double base = dcc2 + mProblem.distance(d, d2);
+                        double straight = mProblem.distance(c, d) + mProblem.distance(c2, d2) - base;
+                        double crossed = mProblem.distance(c, d2) + mProblem.distance(c2, d) - base;
+                        if (straight < bestDelta)
+                        {
+                            bestDelta = straight;
+                            best = {c, c2, d, d2, false};
+                        }
+                        if (crossed < bestDelta)
+                        {
+                            bestDelta = crossed;
+                            best = {c, c2, d, d2, true};
+                        }
+                    }
+                }
+            };
+
+            // the candidates of its cities first, every city outside it when
+            // none of them reaches another sub-tour
+            for (int pass = 0; pass < 2 && best.c < 0; pass++)
+            {
+                for (int segment = s.componentHead[smallest]; segment >= 0; segment = s.segmentNext[segment])
+                {
+                    for (int k = 0, p = s.cuts[segment] + 1; k < s.segmentSize(segment); k++, p++)
+                    {
+                        int c = s.tour[p % n];
+                        if (pass == 0)
+                        {
+                            for (const int* it = mNeighbors.begin(c); it != mNeighbors.end(c); ++it)
+                            {
+                                if (s.componentOf(*it) != smallest)
+                                    consider(c, *it);
+                            }
+                        }
+                        else
+                        {
+                            for (int d = 0; d < n; d++)
+                            {
+                                if (s.componentOf(d) != smallest)
+                                    consider(c, d);
+                            }
+                        }
+                    }
+                }
+            }
+
+            s.unlink(best.c, best.c2);
+            s.unlink(best.d, best.d2);
+            s.connect(best.c, best.crossed ? best.d2 : best.d);
+            s.connect(best.c2, best.crossed ? best.d : best.d2);
+            s.exchanges.push_back(best);
+            gain += bestDelta;
+
+            int into = s.componentOf(best.d);
+            s.componentParent[smallest] = into;
+            s.componentSize[into] += s.componentSize[smallest];
+            s.segmentNext[s.componentTail[into]] = s.componentHead[smallest];
+            s.componentTail[into] = s.componentTail[smallest];
+        }
+
+        if (gain < bestGain)
+        {
+            bestGain = gain;
+            bestCycle = s.order[t];
+            s.bestExchanges = s.exchanges;
+        }
+
+        s.rollback();
+        for (int city: s.touched)
+        {
+            s.partners[2 * city] = -1;
+            s.partners[2 * city + 1] = -1;
+        }
+        s.touched.clear();
+    }
+
+    // replay the best offspring and read its tour
+    const int* cycle = s.cycles.data() + s.cycleOffsets[bestCycle];
+    int length = s.cycleOffsets[bestCycle + 1] - s.cycleOffsets[bestCycle];
+    for (int i = 0; i < length; i += 2)
+        s.unlink(cycle[i], cycle[i + 1]);
+    for (int i = 1; i < length; i += 2)
+        s.connect(cycle[i], cycle[(i + 1) % length]);
+    for (const Exchange& e: s.bestExchanges)
+    {
+        s.unlink(e.c, e.c2);
+        s.unlink(e.d, e.d2);
+        s.connect(e.c, e.crossed ? e.d2 : e.d);
+        s.connect(e.c2, e.crossed ? e.d : e.d2);
+    }
+    s.undo.clear();
+
+    int previous = parent1[0], city = s.link[2 * parent1[0] + 1];
+    child[0] = previous;
+    for (int i = 1; i < n; i++)
+    {
+        child[i] = city;
+        int next = s.link[2 * city] == previous ? s.link[2 * city + 1] : s.link[2 * city];
+        previous = city;
+        city = next;
+    }
+
+    return bestGain;
+}
+
+} // namespace tsp
+} // namespace problems
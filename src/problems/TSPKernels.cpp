@@ -0,0 +1,181 @@
+#include "problems/TSP.hpp"
+#include "problems/TSPKernels.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MHAC_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace problems
+{
+namespace tsp
+{
+
+namespace
+{
+
+inline double edge(const double* x, const double* y, int a, int b, EdgeWeightType type)
+{
+    return City{x[a], y[a]}.distance(City{x[b], y[b]}, type);
+}
+
+// edges from position begin on, including the one closing the tour
+double tailLength(const double* x, const double* y, const int* tour, int begin, int n, EdgeWeightType type)
+{
+    double length = 0;
+    for (int i = begin; i < n - 1; i++)
+        length += edge(x, y, tour[i], tour[i + 1], type);
+    return length + edge(x, y, tour[n - 1], tour[0], type);
+}
+
+#ifdef MHAC_X86_KERNELS
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+// GCC's intrinsics start their results from _mm*_undefined_*, a false positive once inlined
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+
+// the kernels are built for their instruction set whatever the compiler
+// flags, fp-contract is off so no fused multiply-add changes the rounding
+
+__attribute__((target("avx2"), optimize("fp-contract=off")))
+inline __m256d metricAVX2(__m256d squared, EdgeWeightType type)
+{
+    switch (type)
+    {
+        case EdgeWeightType::EUC_2D:
+            return _mm256_floor_pd(_mm256_add_pd(_mm256_sqrt_pd(squared), _mm256_set1_pd(0.5)));
+
+        case EdgeWeightType::CEIL_2D:
+            return _mm256_ceil_pd(_mm256_sqrt_pd(squared));
+
+        case EdgeWeightType::ATT:
+        {
+            __m256d r = _mm256_sqrt_pd(_mm256_div_pd(squared, _mm256_set1_pd(10.0)));
+            __m256d t = _mm256_floor_pd(_mm256_add_pd(r, _mm256_set1_pd(0.5)));
+            __m256d below = _mm256_cmp_pd(t, r, _CMP_LT_OQ);
+            return _mm256_add_pd(t, _mm256_and_pd(below, _mm256_set1_pd(1.0)));
+        }
+
+        default:
+            return _mm256_sqrt_pd(squared);
+    }
+}
+
+__attribute__((target("avx2"), optimize("fp-contract=off")))
+double tourLengthAVX2(const double* x, const double* y, const int* tour, int n, EdgeWeightType type)
+{
+    __m256d sum = _mm256_setzero_pd();
+    int i = 0;
+
+    // edges (tour[i + k], tour[i + k + 1]) for k = 0..3
+    for (; i + 4 < n; i += 4)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i*) (tour + i));
+        __m128i b = _mm_loadu_si128((const __m128i*) (tour + i + 1));
+
+        __m256d dx = _mm256_sub_pd(_mm256_i32gather_pd(x, a, 8), _mm256_i32gather_pd(x, b, 8));
+        __m256d dy = _mm256_sub_pd(_mm256_i32gather_pd(y, a, 8), _mm256_i32gather_pd(y, b, 8));
+        __m256d squared = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+
+        __m256d d = _mm256_cvtps_pd(_mm256_cvtpd_ps(metricAVX2(squared, type)));
+        sum = _mm256_add_pd(sum, d);
+    }
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, sum);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + tailLength(x, y, tour, i, n, type);
+}
+
+__attribute__((target("avx512f"), optimize("fp-contract=off")))
+inline __m512d metricAVX512(__m512d squared, EdgeWeightType type)
+{
+    switch (type)
+    {
+        case EdgeWeightType::EUC_2D:
+            return _mm512_roundscale_pd(_mm512_add_pd(_mm512_sqrt_pd(squared), _mm512_set1_pd(0.5)), _MM_FROUND_TO_NEG_INF);
+
+        case EdgeWeightType::CEIL_2D:
+            return _mm512_roundscale_pd(_mm512_sqrt_pd(squared), _MM_FROUND_TO_POS_INF);
+
+        case EdgeWeightType::ATT:
+        {
+            __m512d r = _mm512_sqrt_pd(_mm512_div_pd(squared, _mm512_set1_pd(10.0)));
+            __m512d t = _mm512_roundscale_pd(_mm512_add_pd(r, _mm512_set1_pd(0.5)), _MM_FROUND_TO_NEG_INF);
+            __mmask8 below = _mm512_cmp_pd_mask(t, r, _CMP_LT_OQ);
+            return _mm512_mask_add_pd(t, below, t, _mm512_set1_pd(1.0));
+        }
+
+        default:
+            return _mm512_sqrt_pd(squared);
+    }
+}
+
+__attribute__((target("avx512f"), optimize("fp-contract=off")))
+double tourLengthAVX512(const double* x, const double* y, const int* tour, int n, EdgeWeightType type)
+{
+    __m512d sum = _mm512_setzero_pd();
+    int i = 0;
+
+    for (; i + 8 < n; i += 8)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i*) (tour + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*) (tour + i + 1));
+
+        __m512d dx = _mm512_sub_pd(_mm512_i32gather_pd(a, x, 8), _mm512_i32gather_pd(b, x, 8));
+        __m512d dy = _mm512_sub_pd(_mm512_i32gather_pd(a, y, 8), _mm512_i32gather_pd(b, y, 8));
+        __m512d squared = _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy));
+
+        __m512d d = _mm512_cvtps_pd(_mm512_cvtpd_ps(metricAVX512(squared, type)));
+        sum = _mm512_add_pd(sum, d);
+    }
+
+    return _mm512_reduce_add_pd(sum) + tailLength(x, y, tour, i, n, type);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+enum class Kernel { SCALAR, AVX2, AVX512 };
+
+Kernel detectKernel()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return Kernel::AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return Kernel::AVX2;
+    return Kernel::SCALAR;
+}
+
+#endif // MHAC_X86_KERNELS
+
+} // namespace
+
+bool hasTourLengthKernel(EdgeWeightType type)
+{
+    return type == EdgeWeightType::EUCLIDEAN || type == EdgeWeightType::EUC_2D ||
+           type == EdgeWeightType::CEIL_2D || type == EdgeWeightType::ATT;
+}
+
+double tourLength(const double* x, const double* y, const int* tour, int n, EdgeWeightType type)
+{
+    if (n < 2)
+        return 0;
+
+#ifdef MHAC_X86_KERNELS
+    static const Kernel kernel = detectKernel();
+    if (kernel == Kernel::AVX512)
+        return tourLengthAVX512(x, y, tour, n, type);
+    if (kernel == Kernel::AVX2)
+        return tourLengthAVX2(x, y, tour, n, type);
+#endif
+
+    return tailLength(x, y, tour, 0, n, type);
+}
+
+} // namespace tsp
+} // namespace problems
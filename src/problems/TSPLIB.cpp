@@ -0,0 +1,293 @@
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "problems/TSP.hpp"
+#include "problems/TSPLIB.hpp"
+
+namespace problems
+{
+namespace tsp
+{
+
+namespace
+{
+
+std::string trim(const std::string& s)
+{
+    size_t first = s.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos)
+        return "";
+    size_t last = s.find_last_not_of(" \t\r\n");
+    return s.substr(first, last - first + 1);
+}
+
+// cursor over the whole file read in one go, numbers are parsed with strtod
+// straight from the buffer which is what keeps large instances fast
+class Reader
+{
+public:
+    explicit Reader(const std::string& path)
+        : mPath(path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            throw std::runtime_error("Cannot open TSPLIB file " + path);
+
+        std::ostringstream buffer;
+        buffer << file.rdbuf();
+        mData = buffer.str();
+        mPos = mData.c_str();
+    }
+
+    bool line(std::string& out)
+    {
+        if (*mPos == '\0')
+            return false;
+
+        const char* eol = mPos;
+        while (*eol != '\0' && *eol != '\n')
+            eol++;
+
+        out.assign(mPos, eol);
+        mPos = *eol == '\0' ? eol : eol + 1;
+        return true;
+    }
+
+    double number()
+    {
+        char* next = nullptr;
+        double value = std::strtod(mPos, &next);
+        if (next == mPos)
+            fail("expected a number");
+        mPos = next;
+        return value;
+    }
+
+    void fail(const std::string& what) const
+    {
+        throw std::runtime_error(mPath + ": " + what);
+    }
+
+private:
+    std::string mPath;
+    std::string mData;
+    const char* mPos;
+};
+
+EdgeWeightType parseEdgeWeightType(const Reader& reader, const std::string& value)
+{
+    if (value == "EUC_2D")
+        return EdgeWeightType::EUC_2D;
+    if (value == "CEIL_2D")
+        return EdgeWeightType::CEIL_2D;
+    if (value == "ATT")
+        return EdgeWeightType::ATT;
+    if (value == "GEO")
+        return EdgeWeightType::GEO;
+    if (value == "EXPLICIT")
+        return EdgeWeightType::EXPLICIT;
+
+    reader.fail("unsupported EDGE_WEIGHT_TYPE " + value);
+    return EdgeWeightType::EUCLIDEAN;
+}
+
+void readCoordinates(Reader& reader, int n, Cities& cities)
+{
+    for (int i = 0; i < n; i++)
+    {
+        int id = reader.number();
+        if (id < 1 || id > n)
+            reader.fail("node id " + std::to_string(id) + " out of range");
+
+        cities[id - 1].x = reader.number();
+        cities[id - 1].y = reader.number();
+    }
+}
+
+void readWeights(Reader& reader, int n, const std::string& format, std::vector<int>& weights)
+{
+    weights.assign((size_t) n * n, 0);
+
+    auto set = [&weights, n](int i, int j, int w) {
+        weights[(size_t) i * n + j] = w;
+        weights[(size_t) j * n + i] = w;
+    };
+
+    // the column-wise formats list the same entries as the opposite
+    // row-wise ones, which is all that matters for a symmetric matrix
+    if (format == "FULL_MATRIX")
+    {
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < n; j++)
+                weights[(size_t) i * n + j] = reader.number();
+    }
+    else if (format == "UPPER_ROW" || format == "LOWER_COL")
+    {
+        for (int i = 0; i < n; i++)
+            for (int j = i + 1; j < n; j++)
+                set(i, j, reader.number());
+    }
+    else if (format == "LOWER_ROW" || format == "UPPER_COL")
+    {
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < i; j++)
+                set(i, j, reader.number());
+    }
+    else if (format == "UPPER_DIAG_ROW" || format == "LOWER_DIAG_COL")
+    {
+        for (int i = 0; i < n; i++)
+            for (int j = i; j < n; j++)
+                set(i, j, reader.number());
+    }
+    else if (format == "LOWER_DIAG_ROW" || format == "UPPER_DIAG_COL")
+    {
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j <= i; j++)
+                set(i, j, reader.number());
+    }
+    else
+    {
+        reader.fail("unsupported EDGE_WEIGHT_FORMAT " + format);
+    }
+}
+
+} // namespace
+
+Instance readTSPLIB(const std::string& path)
+{
+    Reader reader(path);
+    Instance instance;
+    std::string format;
+    bool typeSet = false;
+    int n = 0;
+
+    std::string line;
+    while (reader.line(line))
+    {
+        std::string entry = trim(line);
+        if (entry.empty())
+            continue;
+        if (entry == "EOF")
+            break;
+
+        size_t colon = entry.find(':');
+        std::string key = trim(entry.substr(0, colon));
+        std::string value = colon == std::string::npos ? "" : trim(entry.substr(colon + 1));
+
+        bool isSection = key.size() > 8 && key.compare(key.size() - 8, 8, "_SECTION") == 0;
+        if (isSection && n <= 0)
+            reader.fail(key + " before a valid DIMENSION");
+
+        if (key == "NAME")
+        {
+            instance.name = value;
+        }
+        else if (key == "TYPE")
+        {
+            if (value.compare(0, 3, "TSP") != 0)
+                reader.fail("only symmetric TSP instances are supported, got TYPE " + value);
+        }
+        else if (key == "DIMENSION")
+        {
+            n = std::atoi(value.c_str());
+            instance.cities.assign(n, City{0, 0});
+        }
+        else if (key == "EDGE_WEIGHT_TYPE")
+        {
+            instance.edgeWeightType = parseEdgeWeightType(reader, value);
+            typeSet = true;
+        }
+        else if (key == "EDGE_WEIGHT_FORMAT")
+        {
+            format = value;
+        }
+        else if (key == "NODE_COORD_SECTION" || key == "DISPLAY_DATA_SECTION")
+        {
+            readCoordinates(reader, n, instance.cities);
+        }
+        else if (key == "EDGE_WEIGHT_SECTION")
+        {
+            readWeights(reader, n, format, instance.weights);
+        }
+        else if (key == "FIXED_EDGES_SECTION")
+        {
+            // edges forced into every tour are not supported by the solvers,
+            // the list is skipped up to its -1 terminator
+            while (reader.number() != -1)
+                ;
+        }
+        else if (isSection)
+        {
+            reader.fail("unsupported section " + key);
+        }
+    }
+
+    if (!typeSet)
+        reader.fail("missing EDGE_WEIGHT_TYPE");
+    if (instance.edgeWeightType == EdgeWeightType::EXPLICIT && instance.weights.empty())
+        reader.fail("EXPLICIT instance without an EDGE_WEIGHT_SECTION");
+
+    return instance;
+}
+
+std::vector<int> readTSPLIBTour(const std::string& path)
+{
+    Reader reader(path);
+    std::vector<int> tour;
+    int n = 0;
+
+    std::string line;
+    while (reader.line(line))
+    {
+        std::string entry = trim(line);
+        if (entry.empty())
+            continue;
+        if (entry == "EOF")
+            break;
+
+        size_t colon = entry.find(':');
+        std::string key = trim(entry.substr(0, colon));
+        std::string value = colon == std::string::npos ? "" : trim(entry.substr(colon + 1));
+
+        if (key == "TYPE")
+        {
+            if (value != "TOUR")
+                reader.fail("expected TYPE TOUR, got " + value);
+        }
+        else if (key == "DIMENSION")
+        {
+            n = std::atoi(value.c_str());
+        }
+        else if (key == "TOUR_SECTION")
+        {
+            // ends with -1, or once DIMENSION cities were read
+            while (n <= 0 || (int) tour.size() < n)
+            {
+                int city = reader.number();
+                if (city == -1)
+                    break;
+                if (city < 1 || (n > 0 && city > n))
+                    reader.fail("city " + std::to_string(city) + " out of range");
+                tour.push_back(city - 1);
+            }
+        }
+    }
+
+    std::vector<char> seen(tour.size(), 0);
+    for (int city: tour)
+    {
+        if (city >= (int) tour.size() || seen[city])
+            reader.fail("the tour is not a permutation of the cities");
+        seen[city] = 1;
+    }
+    if (tour.empty() || (n > 0 && (int) tour.size() != n))
+        reader.fail("the tour does not visit all " + std::to_string(n) + " cities");
+
+    return tour;
+}
+
+} // namespace tsp
+} // namespace problems
@@ -0,0 +1,228 @@
+#include <deque>
+#include <vector>
+
+#include "problems/TSP.hpp"
+#include "problems/TSPTour.hpp"
+#include "problems/TSPLocalSearch.hpp"
+
+namespace problems
+{
+namespace tsp
+{
+
+namespace
+{
+
+const double EPS = 1e-6;
+
+// cities whose don't-look bit is off, in the order they were switched off
+class ActiveQueue
+{
+public:
+    explicit ActiveQueue(int n) : mActive(n, 1)
+    {
+        for (int city = 0; city < n; city++)
+            mQueue.push_back(city);
+    }
+
+    bool empty() const { return mQueue.empty(); }
+
+    int pop()
+    {
+        int city = mQueue.front();
+        mQueue.pop_front();
+        mActive[city] = 0;
+        return city;
+    }
+
+    void push(int city)
+    {
+        if (!mActive[city])
+        {
+            mActive[city] = 1;
+            mQueue.push_back(city);
+        }
+    }
+
+private:
+    std::vector<char> mActive;
+    std::deque<int> mQueue;
+};
+
+// 2-opt move replacing edges (a, b) and (c, d) by (a, c) and (b, d), where
+// a -> b ... c -> d is one of the two directions of the tour
+template <typename Tour>
+void flip(Tour& tour, int a, int b, int c, int d)
+{
+    (void) d;
+    if (tour.next(a) == b)
+        tour.reverse(b, c);
+    else
+        tour.reverse(c, b);
+}
+
+} // namespace
+
+LocalSearch::LocalSearch(const TSP& problem, int k)
+    : mProblem(problem),
+      mNeighbors(problem.neighbors.empty() ? problem.makeNeighborLists(k) : problem.neighbors)
+{}
+
+double LocalSearch::improve(std::vector<int>& tour) const
+{
+    ArrayTour t(tour);
+    double gain = run(t);
+    t.get(tour);
+    return gain;
+}
+
+double LocalSearch::improve(TwoLevelList& tour) const
+{
+    return run(tour);
+}
+
+template <typename Tour>
+double LocalSearch::run(Tour& tour) const
+{
+    double gain = 0;
+    if (tour.size() < 5)
+        return gain;
+
+    ActiveQueue queue(tour.size());
+    std::vector<int> touched;
+
+    while (!queue.empty())
+    {
+        int a = queue.pop();
+
+        // keep improving around a, waking up the endpoints of every move made
+        while (twoOpt(tour, a, gain, touched) || orOpt(tour, a, gain, touched))
+        {
+            for (int city: touched)
+                queue.push(city);
+            touched.clear();
+        }
+    }
+
+    return gain;
+}
+
+template <typename Tour>
+bool LocalSearch::twoOpt(Tour& tour, int a, double& gain, std::vector<int>& touched) const
+{
+    for (int dir = 0; dir < 2; dir++)
+    {
+        int b = dir == 0 ? tour.next(a) : tour.prev(a);
+        double dab = mProblem.distance(a, b);
+
+        for (const int* it = mNeighbors.begin(a); it != mNeighbors.end(a); ++it)
+        {
+            int c = *it;
+            double dac = mProblem.distance(a, c);
+            if (dac >= dab)
+                break;
+
+            int d = dir == 0 ? tour.next(c) : tour.prev(c);
+            if (c == b || d == a)
+                continue;
+
+            double delta = dac + mProblem.distance(b, d) - dab - mProblem.distance(c, d);
+            if (delta < -EPS)
+            {
+                if (dir == 0)
+                    flip(tour, a, b, c, d);
+                else
+                    flip(tour, b, a, d, c);
+
+                gain -= delta;
+                touched.insert(touched.end(), {a, b, c, d});
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+template <typename Tour>
+bool LocalSearch::orOpt(Tour& tour, int a, double& gain, std::vector<int>& touched) const
+{
+    int n = tour.size();
+
+    for (int length = 1; length <= 3 && length + 4 <= n; length++)
+    {
+        for (int side = 0; side < 2; side++)
+        {
+            if (length == 1 && side == 1)
+                break;
+
+            // segment s1 -> ... -> s2 of length cities, starting or ending at a
+            int s1 = a, s2 = a;
+            for (int k = 1; k < length; k++)
+            {
+                if (side == 0)
+                    s2 = tour.next(s2);
+                else
+                    s1 = tour.prev(s1);
+            }
+            int mid = length == 3 ? tour.next(s1) : s1;
+            int p = tour.prev(s1);
+            int nx = tour.next(s2);
+
+            auto inSegment = [s1, s2, mid](int city) {
+                return city == s1 || city == s2 || city == mid;
+            };
+
+            double removeGain = mProblem.distance(p, s1) + mProblem.distance(s2, nx) - mProblem.distance(p, nx);
+            if (removeGain <= EPS)
+                continue;
+
+            // reinsert between c and one of its tour neighbors e, with end joined to c
+            for (int endIndex = 0; endIndex < (length == 1 ? 1 : 2); endIndex++)
+            {
+                int end = endIndex == 0 ? s1 : s2;
+                int other = endIndex == 0 ? s2 : s1;
+
+                for (const int* it = mNeighbors.begin(end); it != mNeighbors.end(end); ++it)
+                {
+                    int c = *it;
+                    double dec = mProblem.distance(end, c);
+                    if (dec >= removeGain)
+                        break;
+                    if (inSegment(c))
+                        continue;
+
+                    for (int k = 0; k < 2; k++)
+                    {
+                        int e = k == 0 ? tour.next(c) : tour.prev(c);
+                        if (inSegment(e))
+                            continue;
+
+                        double delta = dec + mProblem.distance(other, e) - mProblem.distance(c, e) - removeGain;
+                        if (delta >= -EPS)
+                            continue;
+
+                        // with first -> second in tour direction, the segment is
+                        // moved by two 2-opt flips and turned by a third if needed
+                        int first = k == 0 ? c : e;
+                        int second = k == 0 ? e : c;
+
+                        flip(tour, p, s1, first, second);   // p first..nx s2..s1 second
+                        flip(tour, p, first, nx, s2);       // p nx..first s2..s1 second
+                        if ((c == first) != (end == s2))
+                            flip(tour, first, s2, s1, second);
+
+                        gain -= delta;
+                        touched.insert(touched.end(), {p, nx, s1, s2, c, e});
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+} // namespace tsp
+} // namespace problems
@@ -0,0 +1,290 @@
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "problems/TSP.hpp"
+#include "problems/TSPNeighbors.hpp"
+
+namespace problems
+{
+namespace tsp
+{
+
+namespace
+{
+const int LEAF_SIZE = 8;
+}
+
+KDTree::KDTree(const Cities& cities)
+    : mX(cities.size()), mY(cities.size()), mIndex(cities.size()), mAxis(cities.size(), 0),
+      mPosition(cities.size()), mRemaining(cities.size(), 0), mRemoved(cities.size(), 0)
+{
+    for (int i = 0; i < (int) cities.size(); i++)
+    {
+        mX[i] = cities[i].x;
+        mY[i] = cities[i].y;
+    }
+
+    std::iota(mIndex.begin(), mIndex.end(), 0);
+    build(0, mIndex.size());
+
+    for (int i = 0; i < (int) mIndex.size(); i++)
+        mPosition[mIndex[i]] = i;
+}
+
+void KDTree::build(int begin, int end)
+{
+    if (begin < end)
+        mRemaining[(begin + end) / 2] = end - begin;
+
+    if (end - begin <= LEAF_SIZE)
+        return;
+
+    double minX = mX[mIndex[begin]], maxX = minX;
+    double minY = mY[mIndex[begin]], maxY = minY;
+    for (int i = begin + 1; i < end; i++)
+    {
+        minX = std::min(minX, mX[mIndex[i]]);
+        maxX = std::max(maxX, mX[mIndex[i]]);
+        minY = std::min(minY, mY[mIndex[i]]);
+        maxY = std::max(maxY, mY[mIndex[i]]);
+    }
+
+    int mid = (begin + end) / 2;
+    char axis = (maxX - minX >= maxY - minY) ? 0 : 1;
+    const std::vector<double>& coord = axis == 0 ? mX : mY;
+
+    std::nth_element(mIndex.begin() + begin, mIndex.begin() + mid, mIndex.begin() + end, [&coord](int a, int b) {
+        return coord[a] < coord[b];
+    });
+    mAxis[mid] = axis;
+
+    build(begin, mid);
+    build(mid + 1, end);
+}
+
+bool KDTree::inQuadrant(int city, int other, int quadrant) const
+{
+    if (quadrant < 0)
+        return true;
+
+    int q = (mX[other] >= mX[city] ? 1 : 0) + (mY[other] >= mY[city] ? 2 : 0);
+    return q == quadrant;
+}
+
+void KDTree::search(int begin, int end, int city, int k, int quadrant, std::vector<Candidate>& heap) const
+{
+    if (end - begin <= LEAF_SIZE)
+    {
+        for (int i = begin; i < end; i++)
+        {
+            int other = mIndex[i];
+            if (other == city || !inQuadrant(city, other, quadrant))
+                continue;
+
+            double dx = mX[other] - mX[city];
+            double dy = mY[other] - mY[city];
+            Candidate c = {dx*dx + dy*dy, other};
+
+            if ((int) heap.size() < k)
+            {
+                heap.push_back(c);
+                std::push_heap(heap.begin(), heap.end());
+            }
+            else if (c.dist < heap.front().dist)
+            {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.back() = c;
+                std::push_heap(heap.begin(), heap.end());
+            }
+        }
+        return;
+    }
+
+    int mid = (begin + end) / 2;
+    int axis = mAxis[mid];
+    double split = axis == 0 ? mX[mIndex[mid]] : mY[mIndex[mid]];
+    double diff = (axis == 0 ? mX[city] : mY[city]) - split;
+
+    // the quadrant bit of this axis, -1 when any side is allowed
+    int side = quadrant < 0 ? -1 : (axis == 0 ? quadrant & 1 : (quadrant >> 1) & 1);
+    // the lower half holds coordinates <= split, the upper half >= split
+    bool lowerAllowed = side != 1 || split >= (axis == 0 ? mX[city] : mY[city]);
+    bool upperAllowed = side != 0 || split < (axis == 0 ? mX[city] : mY[city]);
+
+    bool lowerFirst = diff < 0;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        bool lower = (pass == 0) == lowerFirst;
+        if (pass == 1)
+        {
+            // the middle element, then the far half only if it can still hold something closer
+            search(mid, mid + 1, city, k, quadrant, heap);
+            if ((int) heap.size() == k && diff*diff >= heap.front().dist)
+                break;
+        }
+
+        if (lower && lowerAllowed)
+            search(begin, mid, city, k, quadrant, heap);
+        else if (!lower && upperAllowed)
+            search(mid + 1, end, city, k, quadrant, heap);
+    }
+}
+
+std::vector<int> KDTree::nearest(int city, int k, int quadrant) const
+{
+    std::vector<Candidate> heap;
+    heap.reserve(k);
+
+    if (k > 0)
+        search(0, mIndex.size(), city, k, quadrant, heap);
+
+    std::sort_heap(heap.begin(), heap.end());
+
+    std::vector<int> res(heap.size());
+    for (int i = 0; i < (int) heap.size(); i++)
+        res[i] = heap[i].city;
+    return res;
+}
+
+void KDTree::remove(int city)
+{
+    if (mRemoved[city])
+        return;
+    mRemoved[city] = 1;
+
+    // every range on the way down to the city holds one city less
+    int begin = 0, end = mIndex.size();
+    int position = mPosition[city];
+    while (true)
+    {
+        int mid = (begin + end) / 2;
+        mRemaining[mid]--;
+        if (end - begin <= LEAF_SIZE || position == mid)
+            return;
+
+        if (position < mid)
+            end = mid;
+        else
+            begin = mid + 1;
+    }
+}
+
+int KDTree::nearestRemaining(int city) const
+{
+    Candidate best = {-1, -1};
+    searchRemaining(0, mIndex.size(), city, best);
+    return best.city;
+}
+
+void KDTree::searchRemaining(int begin, int end, int city, Candidate& best) const
+{
+    if (begin >= end || mRemaining[(begin + end) / 2] == 0)
+        return;
+
+    auto visit = [this, city, &best](int other) {
+        if (other == city || mRemoved[other])
+            return;
+
+        double dx = mX[other] - mX[city];
+        double dy = mY[other] - mY[city];
+        double dist = dx*dx + dy*dy;
+        if (best.city < 0 || dist < best.dist)
+            best = {dist, other};
+    };
+
+    if (end - begin <= LEAF_SIZE)
+    {
+        for (int i = begin; i < end; i++)
+            visit(mIndex[i]);
+        return;
+    }
+
+    int mid = (begin + end) / 2;
+    double split = mAxis[mid] == 0 ? mX[mIndex[mid]] : mY[mIndex[mid]];
+    double diff = (mAxis[mid] == 0 ? mX[city] : mY[city]) - split;
+
+    if (diff < 0)
+        searchRemaining(begin, mid, city, best);
+    else
+        searchRemaining(mid + 1, end, city, best);
+
+    visit(mIndex[mid]);
+    if (best.city >= 0 && diff*diff >= best.dist)
+        return;
+
+    if (diff < 0)
+        searchRemaining(mid + 1, end, city, best);
+    else
+        searchRemaining(begin, mid, city, best);
+}
+
+NeighborLists::NeighborLists(const Cities& cities, int k, int quadrantK)
+    : mOffsets(cities.size() + 1, 0)
+{
+    KDTree tree(cities);
+    int n = cities.size();
+    k = std::max(0, std::min(k, n - 1));
+
+    mNeighbors.reserve((long long) n * (k + 4 * quadrantK));
+
+    for (int city = 0; city < n; city++)
+    {
+        std::vector<int> list = tree.nearest(city, k);
+
+        if (quadrantK > 0)
+        {
+            for (int q = 0; q < 4; q++)
+            {
+                for (int other: tree.nearest(city, quadrantK, q))
+                {
+                    if (std::find(list.begin(), list.end(), other) == list.end())
+                        list.push_back(other);
+                }
+            }
+
+            // keep the merged list ordered by distance
+            const City& c = cities[city];
+            auto dist2 = [&cities, &c](int other) {
+                double dx = cities[other].x - c.x;
+                double dy = cities[other].y - c.y;
+                return dx*dx + dy*dy;
+            };
+            std::sort(list.begin(), list.end(), [&dist2](int a, int b) {
+                return dist2(a) < dist2(b);
+            });
+        }
+
+        mNeighbors.insert(mNeighbors.end(), list.begin(), list.end());
+        mOffsets[city + 1] = mNeighbors.size();
+    }
+}
+
+NeighborLists::NeighborLists(int n, int k, const std::function<float(int, int)>& distance)
+    : mOffsets(n + 1, 0)
+{
+    k = std::max(0, std::min(k, n - 1));
+    mNeighbors.reserve((long long) n * k);
+
+    std::vector<std::pair<float, int>> row;
+    row.reserve(n);
+
+    for (int city = 0; city < n; city++)
+    {
+        row.clear();
+        for (int other = 0; other < n; other++)
+        {
+            if (other != city)
+                row.push_back(std::make_pair(distance(city, other), other));
+        }
+
+        std::partial_sort(row.begin(), row.begin() + k, row.end());
+
+        for (int i = 0; i < k; i++)
+            mNeighbors.push_back(row[i].second);
+        mOffsets[city + 1] = mNeighbors.size();
+    }
+}
+
+} // namespace tsp
+} // namespace problems
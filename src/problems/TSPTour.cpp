@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "problems/TSPTour.hpp"
+
+namespace problems
+{
+namespace tsp
+{
+
+void TwoLevelList::set(const std::vector<int>& tour)
+{
+    int n = tour.size();
+    mSegments.clear();
+    mFreeSegments.clear();
+    mSegmentOf.assign(n, 0);
+    mIndexOf.assign(n, 0);
+    mHead = 0;
+    mSegmentCount = 0;
+    if (n == 0)
+        return;
+
+    mGroupSize = std::max(8, (int) std::sqrt((double) n));
+    int count = (n + mGroupSize - 1) / mGroupSize;
+    mSegments.resize(count);
+
+    for (int s = 0; s < count; s++)
+    {
+        std::vector<int> cities(tour.begin() + s * mGroupSize, tour.begin() + std::min(n, (s + 1) * mGroupSize));
+        assign(s, cities);
+        mSegments[s].rank = s;
+        mSegments[s].next = (s + 1) % count;
+        mSegments[s].prev = (s + count - 1) % count;
+    }
+    mSegmentCount = count;
+}
+
+void TwoLevelList::get(std::vector<int>& tour) const
+{
+    tour.clear();
+    tour.reserve(size());
+
+    int s = mHead;
+    for (int k = 0; k < mSegmentCount; k++, s = mSegments[s].next)
+    {
+        const Segment& segment = mSegments[s];
+        if (segment.reversed)
+            tour.insert(tour.end(), segment.cities.rbegin(), segment.cities.rend());
+        else
+            tour.insert(tour.end(), segment.cities.begin(), segment.cities.end());
+    }
+}
+
+void TwoLevelList::reverse(int from, int to)
+{
+    if (from == to)
+        return;
+
+    if (mSegmentOf[from] == mSegmentOf[to] && orientedIndex(from) < orientedIndex(to))
+    {
+        reverseInSegment(from, to);
+        return;
+    }
+
+    // cut the tour so that the path is made of whole segments
+    int k = orientedIndex(from);
+    if (k > 0)
+        split(mSegmentOf[from], k);
+
+    k = orientedIndex(to);
+    if (k + 1 < (int) mSegments[mSegmentOf[to]].cities.size())
+        split(mSegmentOf[to], k + 1);
+
+    int firstSegment = mSegmentOf[from];
+    int lastSegment = mSegmentOf[to];
+    int before = mSegments[firstSegment].prev;
+
+    reverseSegments(firstSegment, lastSegment);
+
+    // the splits leave small segments at both ends of the path
+    merge(before);
+    merge(mSegmentOf[from]);
+    renumber();
+}
+
+void TwoLevelList::reverseInSegment(int from, int to)
+{
+    Segment& segment = mSegments[mSegmentOf[from]];
+    int i = std::min(mIndexOf[from], mIndexOf[to]);
+    int j = std::max(mIndexOf[from], mIndexOf[to]);
+
+    std::reverse(segment.cities.begin() + i, segment.cities.begin() + j + 1);
+    for (int k = i; k <= j; k++)
+        mIndexOf[segment.cities[k]] = k;
+}
+
+void TwoLevelList::reverseSegments(int firstSegment, int lastSegment)
+{
+    int before = mSegments[firstSegment].prev;
+    int after = mSegments[lastSegment].next;
+    bool whole = before == lastSegment;
+
+    for (int s = firstSegment; ; )
+    {
+        Segment& segment = mSegments[s];
+        int next = segment.next;
+        std::swap(segment.next, segment.prev);
+        segment.reversed = !segment.reversed;
+        if (s == lastSegment)
+            break;
+        s = next;
+    }
+
+    if (whole)
+        return;
+
+    // before -> last ... first -> after
+    mSegments[firstSegment].next = after;
+    mSegments[lastSegment].prev = before;
+    mSegments[before].next = lastSegment;
+    mSegments[after].prev = firstSegment;
+}
+
+int TwoLevelList::split(int segment, int at)
+{
+    std::vector<int> head = mSegments[segment].cities;
+    if (mSegments[segment].reversed)
+        std::reverse(head.begin(), head.end());
+    std::vector<int> tail(head.begin() + at, head.end());
+    head.resize(at);
+
+    int created = newSegment();
+    assign(segment, head);
+    assign(created, tail);
+
+    Segment& s = mSegments[segment];
+    Segment& c = mSegments[created];
+    c.prev = segment;
+    c.next = s.next;
+    mSegments[s.next].prev = created;
+    s.next = created;
+    mSegmentCount++;
+
+    return created;
+}
+
+void TwoLevelList::merge(int segment)
+{
+    // joins segment with the ones following it while they fit in one group
+    while (mSegmentCount > 1)
+    {
+        int next = mSegments[segment].next;
+        if (mSegments[segment].cities.size() + mSegments[next].cities.size() > (size_t) mGroupSize)
+            return;
+
+        std::vector<int> cities = mSegments[segment].cities;
+        if (mSegments[segment].reversed)
+            std::reverse(cities.begin(), cities.end());
+        const Segment& n = mSegments[next];
+        if (n.reversed)
+            cities.insert(cities.end(), n.cities.rbegin(), n.cities.rend());
+        else
+            cities.insert(cities.end(), n.cities.begin(), n.cities.end());
+        assign(segment, cities);
+
+        int after = mSegments[next].next;
+        mSegments[segment].next = after;
+        mSegments[after].prev = segment;
+        if (mHead == next)
+            mHead = segment;
+
+        mSegments[next].cities.clear();
+        mFreeSegments.push_back(next);
+        mSegmentCount--;
+    }
+}
+
+void TwoLevelList::assign(int segment, std::vector<int>& cities)
+{
+    Segment& s = mSegments[segment];
+    s.cities.swap(cities);
+    s.reversed = false;
+    for (int i = 0; i < (int) s.cities.size(); i++)
+    {
+        mSegmentOf[s.cities[i]] = segment;
+        mIndexOf[s.cities[i]] = i;
+    }
+}
+
+void TwoLevelList::renumber()
+{
+    int s = mHead;
+    for (int rank = 0; rank < mSegmentCount; rank++, s = mSegments[s].next)
+        mSegments[s].rank = rank;
+}
+
+int TwoLevelList::newSegment()
+{
+    if (!mFreeSegments.empty())
+    {
+        int segment = mFreeSegments.back();
+        mFreeSegments.pop_back();
+        return segment;
+    }
+
+    mSegments.push_back(Segment());
+    return mSegments.size() - 1;
+}
+
+} // namespace tsp
+} // namespace problems
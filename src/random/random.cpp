@@ -3,20 +3,32 @@
 #include <vector>
 #include <numeric>
 #include <random>
-#include <chrono>
 
 #include "random/random.hpp"
 
 namespace mhac_random
 {
 
+// seeded once per thread, constructing a std::random_device on every call
+// costs far more than the draw itself
+static std::mt19937& generator()
+{
+    thread_local std::mt19937 gen(std::random_device{}());
+    return gen;
+}
+
 float random(float start, float end)
 {
-    std::random_device rd;
-    std::mt19937 gen(rd());
     std::uniform_real_distribution<> distr(start, end);  // [start, end]
 
-    return distr(gen);
+    return distr(generator());
+}
+
+int randint(int start, int end)
+{
+    std::uniform_int_distribution<> distr(start, end);  // [start, end]
+
+    return distr(generator());
 }
 
 std::vector<int> sample(int range_size, int count)
@@ -26,15 +38,33 @@ std::vector<int> sample(int range_size, int count)
     // Fill numbers with 0, 1, ..., N-1
     std::iota(numbers.begin(), numbers.end(), 0);
 
-    // Obtain a time-based seed
-    unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-
-    // Shuffle numbers using the default random engine seeded with the above seed
-    std::shuffle(numbers.begin(), numbers.end(), std::default_random_engine(seed));
+    std::shuffle(numbers.begin(), numbers.end(), generator());
 
     numbers.resize(count);
 
     return numbers;
 }
 
+void seed(unsigned value)
+{
+    generator().seed(value);
+}
+
+// splitmix64 finalizer, nearby inputs give unrelated outputs
+static unsigned long long mix(unsigned long long x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+void seedStream(unsigned long long value, unsigned long long stream)
+{
+    unsigned long long a = mix(value);
+    unsigned long long b = mix(a ^ mix(stream));
+    std::seed_seq seq{(unsigned) a, (unsigned) (a >> 32), (unsigned) b, (unsigned) (b >> 32)};
+    generator().seed(seq);
+}
+
 } // namespace mhac_random
\ No newline at end of file
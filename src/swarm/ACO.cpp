@@ -1,6 +1,11 @@
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
 #include "common.hpp"
 #include "logger/logger.hpp"
 #include "random/random.hpp"
+#include "parallel/parallel.hpp"
 
 #include "swarm/ACO.hpp"
 
@@ -9,12 +14,87 @@ namespace swarm
 namespace ACO
 {
 
-PheromoneMatrix::PheromoneMatrix(int size, float initialValue)
-    : size_(size), matrix_(size, std::vector<float>(size, initialValue))
-{}
+PheromoneMatrix::PheromoneMatrix(int size, float initialValue, PheromoneLayout layout)
+    : size_(size), layout_(layout), stride_(0), defaultValue_(initialValue)
+{
+    if (layout == PheromoneLayout::SPARSE)
+        throw std::invalid_argument("a sparse pheromone matrix needs candidate lists");
+
+    // rows padded to whole 64 byte lines
+    stride_ = (size + 15) / 16 * 16;
+    size_t entries = layout == PheromoneLayout::DENSE ? (size_t) size * stride_ : (size_t) size * (size + 1) / 2;
+    values_.assign(entries, initialValue);
+}
+
+PheromoneMatrix::PheromoneMatrix(float initialValue, const std::vector<int>& offsets, const std::vector<int>& candidates)
+    : size_(offsets.empty() ? 0 : offsets.size() - 1), layout_(PheromoneLayout::SPARSE), stride_(0),
+      defaultValue_(initialValue), values_(candidates.size(), initialValue), offsets_(offsets), candidates_(candidates)
+{
+    if (offsets.empty() || offsets.front() != 0 || offsets.back() != (int) candidates.size())
+        throw std::invalid_argument("candidate offsets do not match the candidates");
+}
+
+void PheromoneMatrix::scale(float factor)
+{
+    for (float& value: values_) {
+        value *= factor;
+    }
+    defaultValue_ *= factor;
+}
+
+void PheromoneMatrix::fill(float value)
+{
+    std::fill(values_.begin(), values_.end(), value);
+    defaultValue_ = value;
+}
+
+void PheromoneMatrix::clamp(float low, float high)
+{
+    for (float& value: values_) {
+        value = std::min(std::max(value, low), high);
+    }
+    defaultValue_ = std::min(std::max(defaultValue_, low), high);
+}
+
+void PheromoneMatrix::add(int i, int j, float amount)
+{
+    long long k = index(i, j);
+    if (k >= 0) {
+        values_[k] += amount;
+    }
+}
+
+ChoiceInfo::ChoiceInfo(const Problem& problem, const PheromoneMatrix& pm, float beta)
+    : problem_(&problem), pheromone_(nullptr), alpha_(0), beta_(beta), defaultChoice_(0),
+      heuristic_(pm.values().size(), 0), choice_(pm.values().size(), 0)
+{
+    pm.forEach([this, &problem, beta](int i, int j, long long k) {
+        float eta = i == j ? 0 : problem.heuristic(i, j);
+        heuristic_[k] = eta == 0 ? 0 : std::pow(eta, beta);
+    });
+}
+
+void ChoiceInfo::update(const PheromoneMatrix& pm, float alpha)
+{
+    pheromone_ = &pm;
+    alpha_ = alpha;
+    defaultChoice_ = std::pow(pm.getDefault(), alpha);
+
+    const float* tau = pm.values().data();
+    for (size_t k = 0; k < choice_.size(); k++) {
+        choice_[k] = heuristic_[k] == 0 ? 0 : std::pow(tau[k], alpha) * heuristic_[k];
+    }
+}
+
+float ChoiceInfo::unstored(int i, int j) const
+{
+    float eta = i == j ? 0 : problem_->heuristic(i, j);
+    return eta == 0 ? 0 : defaultChoice_ * std::pow(eta, beta_);
+}
 
 AntColonyOptimization::AntColonyOptimization(ProblemPtr probType)
-    :mProblem(probType), mPheromoneMatrix(nullptr)
+    :mProblem(probType), mPheromoneMatrix(nullptr), mThreads(1), mLayout(PheromoneLayout::DENSE),
+     mUpdate(PheromoneUpdate::BEST), mIterationBestWeight(1), mGlobalBestWeight(1), mStagnationLimit(50)
 {
     globalLogger->flush_on(spdlog::level::err);
     globalLogger->debug("Initializing AntColonyOptimization");
@@ -23,37 +103,167 @@ AntColonyOptimization::AntColonyOptimization(ProblemPtr probType)
 common::SolutionPtr AntColonyOptimization::solve(int generations, int colonySize, float alpha, float beta, float rho)
 {
     common::SolutionPtr bestS = mProblem->generateInitialSolution();
-    bestS->cost = mProblem->evaluateSolution(bestS);
+    bestS->cost = mProblem->evaluate(bestS);
 
-    mPheromoneMatrix = std::make_shared<PheromoneMatrix>(bestS->getSize(), 0);
+    if (mLayout == PheromoneLayout::SPARSE) {
+        std::vector<int> offsets, candidates;
+        if (!mProblem->candidateLists(offsets, candidates))
+            throw std::invalid_argument("the sparse pheromone layout needs a problem with candidate lists");
+        mPheromoneMatrix = std::make_shared<PheromoneMatrix>(0, offsets, candidates);
+    } else {
+        mPheromoneMatrix = std::make_shared<PheromoneMatrix>(bestS->getSize(), 0, mLayout);
+    }
 
-    for (int i = 0; i < mPheromoneMatrix->getSize(); i++) {
-        for (int j = 0; j < mPheromoneMatrix->getSize(); j++) {
-            (*mPheromoneMatrix)(i, j) = mhac_random::random();
-        }
+    if (mUpdate == PheromoneUpdate::MAX_MIN) {
+        // MAX-MIN starts everything at the upper bound
+        float tauMin, tauMax;
+        pheromoneBounds(bestS->cost, tauMin, tauMax);
+        mPheromoneMatrix->fill(tauMax);
+    } else {
+        // uniform in [0, 1], the pairs a sparse matrix does not store get the mean
+        mPheromoneMatrix->forEach([this](int i, int j, long long k) {
+            mPheromoneMatrix->values()[k] = mhac_random::random();
+        });
+        mPheromoneMatrix->setDefault(0.5);
+    }
+
+    if (mProblem->hasHeuristic()) {
+        mProblem->choiceInfo = std::make_shared<ChoiceInfo>(*mProblem, *mPheromoneMatrix, beta);
+        mProblem->choiceInfo->update(*mPheromoneMatrix, alpha);
     }
 
+    mhac_parallel::ThreadPool pool(mhac_parallel::threadCount(mThreads));
+    common::SolutionVec ants(colonySize);
+
+    // every ant draws from its own random stream, picked by the generation
+    // and its index, so the ants are the same on any number of threads
+    unsigned long long seed = mhac_random::randint(0, std::numeric_limits<int>::max());
+    int stagnation = 0;
+
     for (int gen = 0; gen < generations; gen++)
     {
-        for (int k = 0; k < colonySize; k++)
-        {
+        pool.run(colonySize, [&](int k) {
+            mhac_random::seedStream(seed, (unsigned long long) gen * colonySize + k);
+
             common::SolutionPtr ant = mProblem->generateInitialSolution();
 
             ant = mProblem->updateAntPath(ant, mPheromoneMatrix, alpha, beta);
-            ant->cost = mProblem->evaluateSolution(ant);
+            ant->cost = mProblem->evaluate(ant);
+            mProblem->improveSolution(ant);
+            ants[k] = ant;
+        });
 
-            if (ant->cost < bestS->cost)
+        // in ant order, the first of equally good ants wins
+        common::SolutionPtr iterationBest = ants[0];
+        for (int k = 1; k < colonySize; k++)
+        {
+            if (ants[k]->cost < iterationBest->cost)
             {
-                bestS = ant;
-                bestS->cost = ant->cost;
+                iterationBest = ants[k];
             }
         }
+
+        stagnation++;
+        if (iterationBest->cost < bestS->cost)
+        {
+            bestS = iterationBest;
+            stagnation = 0;
+        }
+
+        updatePheromone(iterationBest, bestS, rho);
+
+        if (mUpdate == PheromoneUpdate::MAX_MIN)
+        {
+            float tauMin, tauMax;
+            pheromoneBounds(bestS->cost, tauMin, tauMax);
+            if (stagnation >= mStagnationLimit)
+            {
+                mPheromoneMatrix->fill(tauMax);
+                stagnation = 0;
+            }
+            else
+            {
+                mPheromoneMatrix->clamp(tauMin, tauMax);
+            }
+        }
+
+        if (mProblem->choiceInfo)
+        {
+            mProblem->choiceInfo->update(*mPheromoneMatrix, alpha);
+        }
+
+        if (mProblem->shouldStop(bestS->cost))
+            break;
     }
-    
-    mProblem->updatePheromoneMatrix(bestS, mPheromoneMatrix, rho);
+
+    // the cache is tied to this solve's pheromone matrix
+    mProblem->choiceInfo = nullptr;
 
     return bestS;
 }
 
+void AntColonyOptimization::updatePheromone(common::SolutionPtr iterationBest, common::SolutionPtr globalBest, float rho)
+{
+    if (!mProblem->depositsPheromone())
+    {
+        mProblem->updatePheromoneMatrix(iterationBest, mPheromoneMatrix, rho);
+        return;
+    }
+
+    // one evaporation, O(stored entries), then O(n) per deposit
+    mPheromoneMatrix->scale(1 - rho);
+    if (mIterationBestWeight > 0)
+    {
+        mProblem->depositPheromone(iterationBest, *mPheromoneMatrix, mIterationBestWeight * rho);
+    }
+    if (mGlobalBestWeight > 0)
+    {
+        mProblem->depositPheromone(globalBest, *mPheromoneMatrix, mGlobalBestWeight * rho);
+    }
+}
+
+void AntColonyOptimization::pheromoneBounds(float bestCost, float& tauMin, float& tauMax) const
+{
+    // Stutzle and Hoos: tauMax is the value the global best path converges to
+    // under tau = (1 - rho) * tau + rho * weight / bestCost, tauMin the one
+    // that still gives that path a chance pBest of being built when its
+    // edges sit at tauMax and everything else at tauMin
+    const double pBest = 0.05;
+    int n = mPheromoneMatrix->getSize();
+    double root = std::pow(pBest, 1.0 / std::max(n, 1));
+    double weight = mProblem->depositsPheromone() ? mIterationBestWeight + mGlobalBestWeight : 1;
+
+    tauMax = std::max(weight, 1e-6) / std::max(bestCost, std::numeric_limits<float>::min());
+    tauMin = std::min<double>(tauMax * (1 - root) / (std::max(n / 2.0 - 1, 1.0) * root), tauMax);
+}
+
+void AntColonyOptimization::setThreads(int threads)
+{
+    mThreads = threads;
+}
+
+void AntColonyOptimization::setPheromoneLayout(PheromoneLayout layout)
+{
+    if (layout == PheromoneLayout::SYMMETRIC && !mProblem->isSymmetric())
+        throw std::invalid_argument("the symmetric pheromone layout needs a symmetric problem");
+    mLayout = layout;
+}
+
+void AntColonyOptimization::setPheromoneUpdate(PheromoneUpdate update)
+{
+    mUpdate = update;
+}
+
+void AntColonyOptimization::setDeposits(float iterationBest, float globalBest)
+{
+    mIterationBestWeight = iterationBest;
+    mGlobalBestWeight = globalBest;
+}
+
+void AntColonyOptimization::setStagnationLimit(int generations)
+{
+    mStagnationLimit = generations;
+}
+
 } // namespace ACO
 } // namespace swarm
@@ -0,0 +1,39 @@
+import sys
+sys.path.append("..")
+from checks import mhac, Checks, is_permutation
+
+import random
+
+# randomized check of the permutation crossovers: on random parents of random
+# sizes, both children of every type must be permutations of 0..n-1, and the
+# cycle crossover must take every gene from one of the parents at its position
+
+CrossoverType = mhac.evolutionary.CrossoverType
+types = [CrossoverType.ONE_POINT, CrossoverType.ORDER, CrossoverType.PARTIALLY_MAPPED, CrossoverType.CYCLE]
+trials = 2000
+
+checks = Checks()
+for trial in range(trials):
+    n = random.randint(1, 60)
+    parent1 = random.sample(range(n), n)
+    parent2 = random.sample(range(n), n)
+
+    for crossover_type in types:
+        children = mhac.evolutionary.permutationCrossover(crossover_type, parent1, parent2)
+
+        for child in children:
+            child = list(child)
+            if not checks.expect(is_permutation(child, n), f"{crossover_type} n={n}: child is not a permutation\n"
+                                 f"  parents {parent1} {parent2}\n  child {child}"):
+                continue
+            if crossover_type == CrossoverType.CYCLE:
+                checks.expect(all(child[i] in (parent1[i], parent2[i]) for i in range(n)),
+                              f"{crossover_type} n={n}: gene not taken from a parent at its position")
+
+try:
+    mhac.evolutionary.permutationCrossover(CrossoverType.EDGE_ASSEMBLY, [0, 1, 2], [2, 1, 0])
+    checks.expect(False, "EDGE_ASSEMBLY without an instance did not raise")
+except ValueError:
+    pass
+
+checks.done(f"{trials} trials x {len(types)} crossovers")
@@ -0,0 +1,56 @@
+import sys
+sys.path.append("..")
+from checks import mhac, Checks, tour_solution, is_permutation
+
+import random
+
+# randomized check of the edge assembly crossover (EAX): on random and
+# locally improved parents, every child must be a Hamiltonian tour of the
+# instance and the length EdgeAssembly.cross reports, parent1's plus the
+# returned delta, must match a fresh evaluation of the child; GA_TSP's
+# crossover with EDGE_ASSEMBLY must give tours whose cost is their length
+
+instances = ["../../data/tsp/eil51.tsp", "../../data/tsp/kroA100.tsp", "../../data/tsp/a280.tsp"]
+trials = 200
+
+
+def length(problem, tour):
+    return problem.evaluateSolution(tour_solution(tour))
+
+
+checks = Checks()
+for path in instances:
+    problem = mhac.problems.tsp.GA_TSP.fromFile(path)
+    n = len(problem.cities)
+    eax = mhac.problems.tsp.EdgeAssembly(problem)
+    local_search = mhac.problems.tsp.LocalSearch(problem)
+
+    for trial in range(trials):
+        parents = [tour_solution(random.sample(range(n), n)) for _ in range(2)]
+        # half the pairs are 2-opt + Or-opt optima, which share most edges
+        if trial % 2:
+            for parent in parents:
+                local_search.improve(parent)
+        parent1, parent2 = list(parents[0].tour), list(parents[1].tour)
+
+        child, delta = eax.cross(parent1, parent2)
+        child = list(child)
+        if not checks.expect(is_permutation(child, n), f"{path} trial {trial}: EAX child is not a tour of the {n} cities"):
+            continue
+
+        expected = length(problem, parent1) + delta
+        actual = length(problem, child)
+        checks.expect(abs(actual - expected) <= 1e-5 * max(1.0, actual),
+                      f"{path} trial {trial}: EAX child length {actual}, reported {expected}")
+
+    problem.setEdgeAssembly(True)
+    for trial in range(trials // 10):
+        parent1 = tour_solution(random.sample(range(n), n))
+        parent2 = tour_solution(random.sample(range(n), n))
+        for child in problem.crossover(parent1, parent2):
+            if not checks.expect(is_permutation(list(child.tour), n), f"{path} trial {trial}: GA_TSP child is not a tour"):
+                continue
+            checks.expect(abs(child.cost - length(problem, child.tour)) <= 1e-3 * max(1.0, child.cost),
+                          f"{path} trial {trial}: GA_TSP child cost {child.cost}, length {length(problem, child.tour)}")
+
+checks.done(f"{len(instances)} instances x {trials} trials")
@@ -10,53 +10,6 @@ folder_path = "../../data/jss/imrg/ds1/testbed_1_s"
 best_path = "../../data/jss/imrg/ds1/best/testbed1_small.csv"
 output_file = "results/mhac.csv"
 
-def read_file_input(filepath):
-    with open(filepath) as f:
-        lines = f.readlines()
-        sizes = [int(nr) for nr in lines[0].split()]
-        m, n = sizes[0], sizes[1]
-        arr = np.zeros((n, m))
-
-        for i in range(1, len(lines)):
-            arr[i-1, :] = [int(nr) for nr in lines[i].split()]
-
-    return arr
-
-def nparray_to_timematrix(arr):
-    tm = mhac.problems.jss.TimeMatrix()
-
-    for time_list in arr.tolist():
-        vint = mhac.VectorInt()
-        for duration in time_list:
-            vint.append(int(duration))
-        tm.append(vint)
-
-    return tm
-
-def read_all_files_in_folder(folder_path):
-    # List to hold file contents
-    file_contents = {}
-
-    # Check if the provided path is a directory
-    if not os.path.isdir(folder_path):
-        raise ValueError(f"The provided path '{folder_path}' is not a valid directory.")
-
-    # Iterate over all files in the directory
-    for filename in os.listdir(folder_path):
-        file_path = os.path.join(folder_path, filename)
-
-        # Check if it's a file
-        if os.path.isfile(file_path):
-            try:
-                # Open and read the file
-                with open(file_path, 'r') as file:
-                    content = file.read()
-                    file_contents[filename] = content
-            except Exception as e:
-                print(f"Error reading file {filename}: {e}")
-    
-    return file_contents
-
 class PythonJSSP(mhac.common.Problem):
     def __init__(self, processing_times):
         super().__init__()
@@ -72,10 +25,9 @@ class PythonJSSP(mhac.common.Problem):
     def generateNewSolution(self, initialSol: mhac.problems.jss.JSSS):
         i, j = sorted(random.sample(range(self.N), 2))
         newSol = mhac.problems.jss.JSSS()
-        newSol.schedule = initialSol.schedule  # copying with pybind, not using python refs
-        # old_segment = newSol.tour[i:j+1]
-        # newSol.tour[i:j+1] = old_segment[::-1]  # Slice and reverse the segment
-        newSol.schedule[i], newSol.schedule[j] = newSol.schedule[j], newSol.schedule[i]
+        schedule = list(initialSol.schedule)  # the getter gives a read-only tuple
+        schedule[i], schedule[j] = schedule[j], schedule[i]
+        newSol.schedule = schedule
         return newSol
 
     def evaluateSolution(self, sol: mhac.problems.jss.JSSS):        
@@ -109,15 +61,16 @@ class PythonJSSP_ACO(mhac.swarm.Problem, PythonJSSP):
         PythonJSSP.__init__(self, processing_times)
 
     def updateAntPath(self, ant, pm, alpha, beta):
-        schedule_size = len(ant.schedule)
+        schedule = list(ant.schedule)
+        schedule_size = len(schedule)
         probabilities = np.zeros(schedule_size)
         
         for i in range(schedule_size-1):
-            current_job = ant.schedule[i]
+            current_job = schedule[i]
             sum_probabilities = 0.0
 
             for j in range(i+1, schedule_size):
-                next_job = ant.schedule[j]
+                next_job = schedule[j]
                 # Use the correct method to access elements from PheromoneMatrix
                 pheromone = pm(current_job, next_job) ** alpha
                 
@@ -131,8 +84,9 @@ class PythonJSSP_ACO(mhac.swarm.Problem, PythonJSSP):
             if sum_probabilities > 0:
                 probabilities[i+1:schedule_size] /= sum_probabilities
                 selected_index = random.choices(range(i + 1, schedule_size), weights=probabilities[i + 1:schedule_size])[0]
-                ant.schedule[i + 1], ant.schedule[selected_index] = ant.schedule[selected_index], ant.schedule[i + 1]
+                schedule[i + 1], schedule[selected_index] = schedule[selected_index], schedule[i + 1]
 
+        ant.schedule = schedule
         return ant
 
     def updatePheromoneMatrix(self, ant, pm, rho):
@@ -153,17 +107,20 @@ class PythonJSSP_ACO(mhac.swarm.Problem, PythonJSSP):
             pm.set(i, j, pm(i, j) + deposit)  # Update the value
 
 
-def process_files_pyjssp(file_data):
+def process_files_pyjssp(instances):
     results = []
     total_time = 0
-    for filename, content in file_data.items():
-        # problem = PythonJSSP(nparray_to_timematrix(read_file_input(f"{folder_path}/{filename}")))
+    for instance in instances:
+        # the pure python problems index the times as a list of products
+        processing_times = instance.products.toMatrix()
+
+        # problem = PythonJSSP(processing_times)
         # SA = mhac.physics.SimulatedAnnealing(problem)
 
-        # problem = PythonJSSP_GA(nparray_to_timematrix(read_file_input(f"{folder_path}/{filename}")))
+        # problem = PythonJSSP_GA(processing_times)
         # GA = mhac.evolutionary.GeneticAlgorithm(problem)
 
-        problem = PythonJSSP_ACO(nparray_to_timematrix(read_file_input(f"{folder_path}/{filename}")))
+        problem = PythonJSSP_ACO(processing_times)
         ACO = mhac.swarm.AntColonyOptimization(problem)
 
         start_time = time.time()
@@ -175,14 +132,14 @@ def process_files_pyjssp(file_data):
         end_time = time.time()
         duration = end_time - start_time
 
-        print(f"Processing file: {filename} took {duration:.4f}s")
+        print(f"Processing instance: {instance.name} took {duration:.4f}s")
         print(f"Schedule: {sol.schedule} Cost: {sol.cost}")
 
-        results.append({"filename": filename, "cost": sol.cost, "time": duration})
+        results.append({"filename": instance.name, "cost": sol.cost, "time": duration})
         total_time += duration
 
     print(f"Total time spent solving: {total_time:.4f}s")
     return results
 
-file_data = read_all_files_in_folder(folder_path)
-results = process_files_pyjssp(file_data)
+instances = mhac.problems.jss.read_imrg_directory(folder_path)
+results = process_files_pyjssp(instances)
@@ -7,25 +7,6 @@ import matplotlib.pyplot as plt
 import numpy as np
 
 
-def read_TSP_data(filepath="../../data/tsp/eil101.tsp"):
-    cities = mhac.problems.tsp.Cities()
-
-    with open(filepath, 'r') as infile:
-        Name = infile.readline().strip().split()[1] # NAME
-        FileType = infile.readline().strip().split()[1] # TYPE
-        Comment = infile.readline().strip().split()[1] # COMMENT
-        Dimension = infile.readline().strip().split(":")[1] # DIMENSION
-        EdgeWeightType = infile.readline().strip().split()[1] # EDGE_WEIGHT_TYPE
-        infile.readline()
-
-        for i in range(int(Dimension)):
-            coords = infile.readline().strip().split()[1:]
-            city = mhac.problems.tsp.City(int(coords[0]), int(coords[1]))
-            cities.append(city)
-
-    return cities
-
-
 def displayTour(cities, solution):
     plt.figure(figsize = (16,8))
     N = len(cities)
@@ -67,7 +48,8 @@ class PythonTSP(mhac.physics.Problem):
         return val
     
 
-problem = PythonTSP(read_TSP_data())
+# the problem is deliberately written in python, only the file is read natively
+problem = PythonTSP(mhac.problems.tsp.read_tsplib("../../data/tsp/eil101.tsp").cities)
 SA = mhac.physics.SimulatedAnnealing(problem)
 sol = SA.solve(1000., 0.000001)
 displayTour(problem.cities, sol.tour)
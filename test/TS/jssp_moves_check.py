@@ -0,0 +1,101 @@
+import sys
+sys.path.append("..")
+from checks import mhac, Checks
+
+import random
+
+# randomized check of the JSSP move scoring against full evaluations: in both
+# neighbourhoods, evaluateMove must give the change applyMove makes to
+# evaluateSolution and undoMove must restore the schedule; bestInsertion must
+# find the best position of a job by brute force, and the NEH schedule must be
+# the one a plain python NEH builds with evaluateSolution on partial schedules
+
+instances = [
+    "../../data/jss/imrg/ds1/testbed_1_s/t1s_0001.txt",
+    "../../data/jss/imrg/ds1/testbed_1_b/t1_0001.txt",
+    "../../data/jss/imrg/ds1/testbed_2_b/t2_0001.txt",
+    "../../data/jss/imrg/ds2/cos_tardiness_BIG/bt_0.2_0.2_0001.txt",
+]
+moves = 2000
+insertions = 50
+Neighborhood = mhac.problems.jss.Neighborhood
+
+
+def schedule_solution(schedule):
+    sol = mhac.problems.jss.JSSS()
+    sol.schedule = list(schedule)
+    return sol
+
+
+def total(problem, schedule):
+    return problem.evaluateSolution(schedule_solution(schedule))
+
+
+def close(a, b):
+    return abs(a - b) <= 1e-6 * max(1.0, abs(a), abs(b))
+
+
+def neh(problem):
+    products = problem.products
+    work = [sum(products(job, machine) for machine in range(products.machines)) for job in range(len(products))]
+    schedule = []
+    # sorted is stable, ties keep the job order; the first best position wins
+    for job in sorted(range(len(products)), key=lambda job: -work[job]):
+        totals = [total(problem, schedule[:k] + [job] + schedule[k:]) for k in range(len(schedule) + 1)]
+        k = totals.index(min(totals))
+        schedule.insert(k, job)
+    return schedule
+
+
+checks = Checks()
+for path in instances:
+    problem = mhac.problems.jss.JSSP.fromFile(path)
+    n = len(problem.products)
+
+    for neighborhood in [Neighborhood.SWAP, Neighborhood.INSERTION]:
+        problem.neighborhood = neighborhood
+        sol = schedule_solution(random.sample(range(n), n))
+        for trial in range(moves):
+            move = problem.generateMove(sol)
+            before = list(sol.schedule)
+            cost = problem.evaluateSolution(sol)
+            delta = problem.evaluateMove(sol, move)
+            problem.applyMove(sol, move)
+            after = problem.evaluateSolution(sol)
+            checks.expect(close(cost + delta, after),
+                          f"{path} {neighborhood} move ({move.i}, {move.j}): delta {delta}, evaluated {after - cost}")
+
+            if trial % 3 == 0:
+                problem.undoMove(sol, move)
+                checks.expect(list(sol.schedule) == before, f"{path} {neighborhood} move ({move.i}, {move.j}) not undone")
+            # now and then a schedule the moves did not make
+            if trial % 100 == 0:
+                sol.schedule = random.sample(range(n), n)
+
+    sol = schedule_solution(random.sample(range(n), n))
+    for trial in range(insertions):
+        schedule = list(sol.schedule)
+        cost = problem.evaluateSolution(sol)
+        position = random.randrange(n)
+        target, delta = problem.bestInsertion(sol, position)
+
+        job = schedule[position]
+        rest = schedule[:position] + schedule[position + 1:]
+        best = min([total(problem, rest[:k] + [job] + rest[k:]) for k in range(n) if k != position] + [cost])
+        moved = rest[:target] + [job] + rest[target:]
+        checks.expect(close(cost + delta, best) and close(total(problem, moved), best),
+                      f"{path} position {position}: best insertion at {target} with delta {delta}, brute force {best - cost}")
+        sol.schedule = moved if delta < 0 else random.sample(range(n), n)
+
+    cost = problem.evaluateSolution(sol)
+    gain = problem.insertionLocalSearch(sol)
+    checks.expect(close(cost - gain, problem.evaluateSolution(sol)),
+                  f"{path}: insertion local search gain {gain}, evaluated {cost - problem.evaluateSolution(sol)}")
+
+    expected = neh(problem)
+    schedule = list(problem.constructSchedule(mhac.problems.jss.InitialSchedule.NEH))
+    checks.expect(schedule == expected, f"{path}: NEH schedule {schedule}, python NEH {expected}")
+    problem.initialSchedule = mhac.problems.jss.InitialSchedule.NEH
+    checks.expect(list(problem.generateInitialSolution().schedule) == expected, f"{path}: seeded schedule is not the NEH one")
+
+checks.done(f"{len(instances)} instances x {moves} moves per neighbourhood")
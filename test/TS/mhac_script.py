@@ -7,25 +7,6 @@ import matplotlib.pyplot as plt
 import numpy as np
 
 
-def read_TSP_data(filepath="../../data/tsp/eil101.tsp"):
-    cities = mhac.problems.tsp.Cities()
-
-    with open(filepath, 'r') as infile:
-        Name = infile.readline().strip().split()[1]
-        FileType = infile.readline().strip().split()[1]
-        Comment = infile.readline().strip().split()[1]
-        Dimension = infile.readline().strip().split(":")[1]
-        EdgeWeightType = infile.readline().strip().split()[1]
-        infile.readline()
-
-        for i in range(int(Dimension)):
-            coords = infile.readline().strip().split()[1:]
-            city = mhac.problems.tsp.City(int(coords[0]), int(coords[1]))
-            cities.append(city)
-
-    return cities
-
-
 def displayTour(cities, solution):
     plt.figure(figsize = (16,8))
     N = len(cities)
@@ -35,7 +16,7 @@ def displayTour(cities, solution):
     plt.show()
 
 
-problem = mhac.problems.tsp.TSP(read_TSP_data())
+problem = mhac.problems.tsp.TSP.fromFile("../../data/tsp/eil101.tsp")
 TS = mhac.math.TabuSearch(problem)
 sol = TS.solve(1000, 10, 20)
 displayTour(problem.cities, sol.tour)
\ No newline at end of file
@@ -0,0 +1,55 @@
+import sys
+sys.path.append("..")
+from checks import mhac, Checks, tour_solution
+
+import random
+from collections import deque
+
+# randomized check of the tabu list against a plain python model: after
+# every push, a hash is tabu exactly when it is among the latest capacity
+# pushes, however often it repeats, and unhashed solutions (hash 0) are
+# found by value; then tabu search runs in both modes and returns
+# solutions whose cost and stored hash match a fresh evaluation and hash
+
+trials = 200
+pushes = 500
+
+checks = Checks()
+for trial in range(trials):
+    capacity = random.randint(1, 20)
+    # few distinct hashes, so they repeat within the list and leave it one copy at a time
+    pool = [random.getrandbits(64) | 1 for _ in range(random.randint(1, 3 * capacity))]
+    tours = [tuple(random.sample(range(6), 6)) for _ in range(4)]
+
+    tabu = mhac.math.TabuList(capacity)
+    model = deque(maxlen=capacity)
+    for push in range(pushes):
+        if random.random() < 0.1:
+            entry = random.choice(tours)
+            tabu.push(tour_solution(entry), 0)
+        else:
+            entry = random.choice(pool)
+            tabu.push(tour_solution(tours[0]), entry)
+        model.append(entry)
+
+        for h in pool:
+            expected = h in model
+            checks.expect(tabu.contains(tour_solution(tours[0]), h) == expected,
+                          f"trial {trial} push {push}: hash {h} should be tabu: {expected}")
+        for tour in tours:
+            expected = tour in model
+            checks.expect(tabu.contains(tour_solution(tour), 0) == expected,
+                          f"trial {trial} push {push}: tour {tour} should be tabu: {expected}")
+
+problem = mhac.problems.tsp.TSP.fromFile("../../data/tsp/eil101.tsp")
+problem.buildNeighborLists(10)
+for mode in [mhac.math.TabuMode.SOLUTION, mhac.math.TabuMode.ATTRIBUTE]:
+    TS = mhac.math.TabuSearch(problem)
+    TS.setTabuMode(mode)
+    sol = TS.solve(20000, 10, 20)
+    fresh = tour_solution(sol.tour)
+    checks.expect(sol.hash() == fresh.hash(), f"{mode}: stored hash {sol.hash()}, fresh hash {fresh.hash()}")
+    checks.expect(abs(sol.cost - problem.evaluateSolution(fresh)) <= 1e-3 * sol.cost,
+                  f"{mode}: cost {sol.cost}, evaluated {problem.evaluateSolution(fresh)}")
+
+checks.done(f"{trials} tabu lists x {pushes} pushes")
@@ -0,0 +1,93 @@
+import sys
+sys.path.append("..")
+from checks import mhac, Checks
+
+import random
+
+# randomized check of the two-level list against a plain array tour: after
+# every reversal, which splits and merges segments, next, prev and between
+# must agree with the array on the ends of the path and on random cities,
+# the whole tour every so often, and reversing the path back undoes it
+
+sizes = [1, 2, 3, 4, 7, 16, 50, 101, 500, 1000, 5000]
+reversals = 20000
+
+
+class ArrayTour:
+    def __init__(self, tour):
+        self.tour = list(tour)
+        self.positions = [0] * len(tour)
+        for i, city in enumerate(self.tour):
+            self.positions[city] = i
+
+    def next(self, city):
+        return self.tour[(self.positions[city] + 1) % len(self.tour)]
+
+    def prev(self, city):
+        return self.tour[self.positions[city] - 1]
+
+    def between(self, a, b, c):
+        n = len(self.tour)
+        pa = self.positions[a]
+        return (self.positions[b] - pa) % n <= (self.positions[c] - pa) % n
+
+    # the path going forward from first to last, never its complement
+    def reverse(self, first, last):
+        n = len(self.tour)
+        i = self.positions[first]
+        length = (self.positions[last] - i) % n + 1
+        indexes = [(i + k) % n for k in range(length)]
+        cities = [self.tour[k] for k in reversed(indexes)]
+        for k, city in zip(indexes, cities):
+            self.tour[k] = city
+            self.positions[city] = k
+
+
+# the same cycle walked the same way, whatever city each starts from
+def same_cycle(tour, reference):
+    if len(tour) != len(reference):
+        return False
+    start = tour.index(reference[0]) if reference else 0
+    return tour[start:] + tour[:start] == reference
+
+
+checks = Checks()
+for n in sizes:
+    tour = random.sample(range(n), n)
+    reference = ArrayTour(tour)
+    tested = mhac.problems.tsp.TwoLevelList(tour)
+    steps = reversals // len(sizes)
+
+    for step in range(steps):
+        first = random.randrange(n)
+        # mostly short paths, as 2-opt with neighbor lists makes them
+        length = random.randint(1, min(n, 50)) if random.random() < 0.5 else random.randint(1, n)
+        last = first
+        for _ in range(length - 1):
+            last = reference.next(last)
+
+        saved = list(reference.tour)
+        reference.reverse(first, last)
+        tested.reverse(first, last)
+
+        cities = [first, last] + [random.randrange(n) for _ in range(8)]
+        for city in cities:
+            checks.expect(tested.next(city) == reference.next(city),
+                          f"n={n} step {step}: next({city}) is {tested.next(city)}, expected {reference.next(city)}")
+            checks.expect(tested.prev(city) == reference.prev(city),
+                          f"n={n} step {step}: prev({city}) is {tested.prev(city)}, expected {reference.prev(city)}")
+        for _ in range(8):
+            a, b, c = (random.choice(cities) for _ in range(3))
+            checks.expect(tested.between(a, b, c) == reference.between(a, b, c),
+                          f"n={n} step {step}: between({a}, {b}, {c}) is {tested.between(a, b, c)}")
+
+        if step % 100 == 0:
+            checks.expect(same_cycle(list(tested.tour), reference.tour), f"n={n} step {step}: tours differ")
+        if step % 10 == 0:
+            tested.reverse(last, first)
+            reference.reverse(last, first)
+            checks.expect(same_cycle(list(tested.tour), saved), f"n={n} step {step}: reverse({last}, {first}) did not undo")
+
+    checks.expect(len(tested) == n and same_cycle(list(tested.tour), reference.tour), f"n={n}: final tours differ")
+
+checks.done(f"{len(sizes)} sizes x {reversals // len(sizes)} reversals")
@@ -0,0 +1,37 @@
+import sys
+sys.path.append("/home/marin/projects/mhac/build/debug/")
+import mhac
+
+import random
+
+# shared by the randomized *_check.py scripts, run like them from their own
+# directory: a script makes a Checks, reports what fails through it and
+# finishes with done(), which exits with 1 when anything failed
+
+
+class Checks:
+    def __init__(self, seed=1):
+        random.seed(seed)
+        mhac.seed(seed)
+        self.failures = 0
+
+    # prints the message when ok is false, returns ok
+    def expect(self, ok, message):
+        if not ok:
+            print(message)
+            self.failures += 1
+        return ok
+
+    def done(self, summary):
+        print(f"{summary}, {self.failures} failures")
+        sys.exit(1 if self.failures else 0)
+
+
+def tour_solution(tour):
+    sol = mhac.problems.tsp.TSS()
+    sol.tour = list(tour)
+    return sol
+
+
+def is_permutation(values, n):
+    return len(values) == n and sorted(values) == list(range(n))